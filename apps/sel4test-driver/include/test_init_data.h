@@ -10,8 +10,22 @@
 #include <sel4/sel4.h>
 #include <sel4test/test.h>
 #include <sel4utils/elf.h>
+#include <utils/util.h>
 
 #define TEST_PROCESS_CSPACE_SIZE_BITS 17
+/* The test process CSpace has two levels. The root CNode has
+ * TEST_PROCESS_CSPACE_L1_BITS slots, each of which can hold a CNode of
+ * TEST_PROCESS_CSPACE_L2_BITS slots, so together they resolve
+ * TEST_PROCESS_CSPACE_SIZE_BITS. The driver only creates the first level two
+ * CNode (at index 0, so its slots have the same cptrs as in a single level
+ * CSpace); the test process allocates the others as it needs them. */
+#define TEST_PROCESS_CSPACE_L2_BITS 12
+#define TEST_PROCESS_CSPACE_L1_BITS (TEST_PROCESS_CSPACE_SIZE_BITS - TEST_PROCESS_CSPACE_L2_BITS)
+
+/* the number of 4K pages an elf region is mapped with */
+#define ELF_REGION_PAGES(region) \
+    ((ROUND_UP((region).elf_vstart + (region).size, PAGE_SIZE_4K) - \
+      ROUND_DOWN((region).elf_vstart, PAGE_SIZE_4K)) / PAGE_SIZE_4K)
 /* Init data shared between sel4test-driver and the sel4test-tests app -- the
  * sel4test-driver creates a shmem page to be shared between the driver and the
  * test child processes, and uses this struct to pass the data in the shmem
@@ -46,9 +60,9 @@ typedef struct {
      */
     seL4_CPtr timer_ntfn;
 
-    /* size of the test processes cspace */
+    /* number of bits the test processes cspace resolves */
     seL4_Word cspace_size_bits;
-    /* range of free slots in the cspace */
+    /* range of free slots in the first level two cnode of the cspace */
     seL4_SlotRegion free_slots;
 
     /* range of untyped memory in the cspace */
@@ -56,10 +70,12 @@ typedef struct {
     /* size of untyped that each untyped cap corresponds to
      * (size of the cap at untypeds.start is untyped_size_bits_lits[0]) */
     uint8_t untyped_size_bits_list[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
-    /* name of the test to run */
-    char name[TEST_NAME_MAX];
+    /* index of the test to run in the _test_case section of the tests app */
+    int test_index;
     /* priority the test process is running at */
     int priority;
+    /* the durations the tests sleep for are divided by this, CONFIG_SEL4TEST_TIME_SCALE */
+    seL4_Word time_scale;
 
     /* sched control cap */
     seL4_CPtr sched_ctrl;
@@ -78,6 +94,11 @@ typedef struct {
     /* the number of elf regions */
     int num_elf_regions;
 
+    /* If CONFIG_SEL4TEST_SHARE_HELPER_TEXT is set, the first of the frame caps
+     * of each elf region that is not writable, which are in consecutive slots
+     * in page order. seL4_CapNull for writable regions. */
+    seL4_CPtr elf_region_frames[MAX_REGIONS];
+
     /* the number of pages in the stack */
     int stack_pages;
 
@@ -92,4 +113,18 @@ typedef struct {
 
 } test_init_data_t;
 
+/* Layout of the message sel4test-tests sends its result back to the driver in.
+ * With CONFIG_SEL4TEST_REPORT_RESOURCES the result is followed by the peak
+ * resources the test process allocated, otherwise only the result is sent. */
+enum {
+    SEL4TEST_RESULT_MR,
+    SEL4TEST_RESULT_PEAK_CSLOTS_MR,
+    /* in bytes */
+    SEL4TEST_RESULT_PEAK_UNTYPED_MR,
+    /* one word per object type, in bytes */
+    SEL4TEST_RESULT_PEAK_OBJECTS_MR,
+    SEL4TEST_RESULT_LENGTH = SEL4TEST_RESULT_PEAK_OBJECTS_MR + seL4_ObjectTypeCount
+};
+
+compile_time_assert(result_fits_in_ipc_buffer, SEL4TEST_RESULT_LENGTH <= seL4_MsgMaxLength);
 compile_time_assert(init_data_fits_in_ipc_buffer, sizeof(test_init_data_t) < PAGE_SIZE_4K);
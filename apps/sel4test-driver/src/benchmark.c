@@ -0,0 +1,334 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+#include <stdio.h>
+#include <string.h>
+#include <sel4/sel4.h>
+#include <utils/util.h>
+#include <vspace/vspace.h>
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+#include <sel4/benchmark_utilisation_types.h>
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+#include <sel4/benchmark_track_types.h>
+#endif
+
+#include "benchmark.h"
+
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+static void utilisation_start(driver_env_t env)
+{
+    env->utilisation.valid = false;
+    seL4_BenchmarkResetThreadUtilisation(env->test_process->thread.tcb.cptr);
+    /* also restarts the idle thread and total counts */
+    seL4_BenchmarkResetLog();
+}
+
+static void utilisation_end(driver_env_t env)
+{
+    uint64_t *__attribute__((__may_alias__)) ipcbuffer = (uint64_t *) & (seL4_GetIPCBuffer()->msg[0]);
+
+    seL4_BenchmarkFinalizeLog();
+    seL4_BenchmarkGetThreadUtilisation(env->test_process->thread.tcb.cptr);
+    THREAD_MEMORY_FENCE();
+
+    /* Only the root thread of the test is counted, not its helpers. Tests that
+     * reset the benchmark log themselves (BENCHMARK_0001) only report the time
+     * since they did so. */
+    env->utilisation.thread = ipcbuffer[BENCHMARK_TCB_UTILISATION];
+    env->utilisation.idle = ipcbuffer[BENCHMARK_IDLE_LOCALCPU_UTILISATION];
+    env->utilisation.total = ipcbuffer[BENCHMARK_TOTAL_UTILISATION];
+    env->utilisation.valid = true;
+}
+
+static void utilisation_report(driver_env_t env)
+{
+    uint64_t total = env->utilisation.total;
+
+    if (!env->utilisation.valid) {
+        return;
+    }
+    env->utilisation.valid = false;
+
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"thread_utilisation\" value=\"%llu\"/>\n",
+               (unsigned long long) env->utilisation.thread);
+        printf("\t\t\t<property name=\"idle_utilisation\" value=\"%llu\"/>\n",
+               (unsigned long long) env->utilisation.idle);
+        printf("\t\t\t<property name=\"total_utilisation\" value=\"%llu\"/>\n",
+               (unsigned long long) total);
+    } else {
+        printf("\tUtilisation: test %llu (%llu%%), idle %llu (%llu%%), total %llu cycles\n",
+               (unsigned long long) env->utilisation.thread,
+               (unsigned long long)(total ? env->utilisation.thread * 100 / total : 0),
+               (unsigned long long) env->utilisation.idle,
+               (unsigned long long)(total ? env->utilisation.idle * 100 / total : 0),
+               (unsigned long long) total);
+    }
+}
+#endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+/* distinct invocation labels and IRQs tracked per test, the rest are
+ * reported together as "other" */
+#define MAX_TRACKED_LABELS 32
+#define MAX_TRACKED_IRQS 8
+/* number of kernel entry paths (entry_type_t) */
+#define NUM_ENTRY_PATHS BIT(3)
+/* syscall_no is a 4 bit field */
+#define NUM_SYSCALLS BIT(4)
+
+typedef struct entry_stats {
+    seL4_Word key;
+    seL4_Word count;
+    uint64_t cycles;
+} entry_stats_t;
+
+static struct {
+    seL4_Word entries;
+    uint64_t cycles;
+    seL4_Word fastpath;
+    entry_stats_t paths[NUM_ENTRY_PATHS];
+    entry_stats_t syscalls[NUM_SYSCALLS];
+    entry_stats_t labels[MAX_TRACKED_LABELS + 1];
+    int num_labels;
+    entry_stats_t irqs[MAX_TRACKED_IRQS + 1];
+    int num_irqs;
+} kernel_entries;
+
+static const char *entry_path_names[NUM_ENTRY_PATHS] = {
+    [Entry_Interrupt] = "interrupt",
+    [Entry_UnknownSyscall] = "unknown_syscall",
+    [Entry_UserLevelFault] = "user_fault",
+    [Entry_DebugFault] = "debug_fault",
+    [Entry_VMFault] = "vm_fault",
+    [Entry_Syscall] = "syscall",
+    [Entry_UnimplementedDevice] = "unimplemented_device",
+};
+
+static void entry_stats_add(entry_stats_t *stats, seL4_Word key, uint32_t duration)
+{
+    stats->key = key;
+    stats->count++;
+    stats->cycles += duration;
+}
+
+/* find the slot for key in table, using the last slot once the table is full */
+static entry_stats_t *entry_stats_find(entry_stats_t *table, int *num, int max, seL4_Word key)
+{
+    for (int i = 0; i < *num; i++) {
+        if (table[i].key == key) {
+            return &table[i];
+        }
+    }
+    if (*num < max) {
+        return &table[(*num)++];
+    }
+    return &table[max];
+}
+
+static void kernel_entries_init(driver_env_t env)
+{
+    env->kernel_log = vspace_new_pages(&env->vspace, seL4_AllRights, 1, seL4_LargePageBits);
+    ZF_LOGF_IF(env->kernel_log == NULL, "Failed to allocate kernel log buffer");
+    env->kernel_log_cap = vspace_get_cap(&env->vspace, env->kernel_log);
+}
+
+static void kernel_entries_start(driver_env_t env)
+{
+    /* set the buffer every time, as tests such as SMPIRQ0001 install their own */
+    int error = seL4_BenchmarkSetLogBuffer(env->kernel_log_cap);
+    ZF_LOGF_IF(error, "Failed to set kernel log buffer");
+    memset(&kernel_entries, 0, sizeof(kernel_entries));
+}
+
+static void kernel_entries_end(driver_env_t env, seL4_Word num_entries)
+{
+    benchmark_track_kernel_entry_t *log = env->kernel_log;
+
+    for (seL4_Word i = 0; i < num_entries; i++) {
+        kernel_entry_t entry = log[i].entry;
+        uint32_t duration = log[i].duration;
+
+        kernel_entries.entries++;
+        kernel_entries.cycles += duration;
+        entry_stats_add(&kernel_entries.paths[entry.path], entry.path, duration);
+
+        if (entry.path == Entry_Syscall) {
+            entry_stats_add(&kernel_entries.syscalls[entry.syscall_no], entry.syscall_no, duration);
+            entry_stats_add(entry_stats_find(kernel_entries.labels, &kernel_entries.num_labels,
+                                             MAX_TRACKED_LABELS, entry.invocation_tag),
+                            entry.invocation_tag, duration);
+            kernel_entries.fastpath += entry.is_fastpath;
+        } else if (entry.path == Entry_Interrupt) {
+            entry_stats_add(entry_stats_find(kernel_entries.irqs, &kernel_entries.num_irqs,
+                                             MAX_TRACKED_IRQS, entry.word),
+                            entry.word, duration);
+        }
+    }
+}
+
+/* print one line of the summary, labelled with name or, if that is NULL, the key */
+static void entry_stats_print(const char *kind, const char *name, entry_stats_t *stats)
+{
+    char key[WORD_STRING_SIZE];
+
+    if (stats->count == 0) {
+        return;
+    }
+    if (name == NULL) {
+        snprintf(key, sizeof(key), "%lu", (unsigned long) stats->key);
+        name = key;
+    }
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"kernel_%s_%s\" value=\"n=%lu cycles=%llu\"/>\n", kind, name,
+               (unsigned long) stats->count, (unsigned long long) stats->cycles);
+    } else {
+        printf("\t\t%s %s: n=%lu cycles=%llu\n", kind, name, (unsigned long) stats->count,
+               (unsigned long long) stats->cycles);
+    }
+}
+
+static void kernel_entries_report(driver_env_t env)
+{
+    if (kernel_entries.entries == 0) {
+        return;
+    }
+
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"kernel_entries\" value=\"n=%lu cycles=%llu fastpath=%lu\"/>\n",
+               (unsigned long) kernel_entries.entries, (unsigned long long) kernel_entries.cycles,
+               (unsigned long) kernel_entries.fastpath);
+    } else {
+        printf("\tKernel entries: n=%lu cycles=%llu fastpath=%lu\n", (unsigned long) kernel_entries.entries,
+               (unsigned long long) kernel_entries.cycles, (unsigned long) kernel_entries.fastpath);
+    }
+
+    for (int i = 0; i < NUM_ENTRY_PATHS; i++) {
+        if (i != Entry_Syscall && i != Entry_Interrupt) {
+            /* faults and other entries are only broken down by path */
+            entry_stats_print("path", entry_path_names[i], &kernel_entries.paths[i]);
+        }
+    }
+    for (int i = 0; i < NUM_SYSCALLS; i++) {
+        entry_stats_print("syscall", NULL, &kernel_entries.syscalls[i]);
+    }
+    for (int i = 0; i < kernel_entries.num_labels; i++) {
+        entry_stats_print("label", NULL, &kernel_entries.labels[i]);
+    }
+    entry_stats_print("label", "other", &kernel_entries.labels[MAX_TRACKED_LABELS]);
+    for (int i = 0; i < kernel_entries.num_irqs; i++) {
+        entry_stats_print("irq", NULL, &kernel_entries.irqs[i]);
+    }
+    entry_stats_print("irq", "other", &kernel_entries.irqs[MAX_TRACKED_IRQS]);
+
+    if (kernel_entries.entries >= BIT(seL4_LargePageBits) / sizeof(benchmark_track_kernel_entry_t)) {
+        if (config_set(CONFIG_PRINT_XML)) {
+            printf("\t\t\t<property name=\"kernel_log_full\" value=\"1\"/>\n");
+        } else {
+            printf("\t\tKernel log full, later entries were not recorded\n");
+        }
+    }
+    kernel_entries.entries = 0;
+}
+#endif /* CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES */
+
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+static void resources_read(driver_env_t env, seL4_MessageInfo_t info)
+{
+    /* tests that abort only send back their result */
+    env->resources.valid = seL4_MessageInfo_get_length(info) >= SEL4TEST_RESULT_LENGTH;
+    if (!env->resources.valid) {
+        return;
+    }
+    env->resources.peak_cslots = seL4_GetMR(SEL4TEST_RESULT_PEAK_CSLOTS_MR);
+    env->resources.peak_untyped = seL4_GetMR(SEL4TEST_RESULT_PEAK_UNTYPED_MR);
+    for (int i = 0; i < seL4_ObjectTypeCount; i++) {
+        env->resources.peak_objects[i] = seL4_GetMR(SEL4TEST_RESULT_PEAK_OBJECTS_MR + i);
+    }
+}
+
+static void resources_report(driver_env_t env)
+{
+    if (!env->resources.valid) {
+        return;
+    }
+    env->resources.valid = false;
+
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"peak_cslots\" value=\"%lu\"/>\n",
+               (unsigned long) env->resources.peak_cslots);
+        printf("\t\t\t<property name=\"peak_untyped\" value=\"%lu\"/>\n",
+               (unsigned long) env->resources.peak_untyped);
+    } else {
+        printf("\tResources: peak cslots %lu of %lu, peak untyped %lu bytes\n",
+               (unsigned long) env->resources.peak_cslots,
+               (unsigned long) BIT(TEST_PROCESS_CSPACE_SIZE_BITS),
+               (unsigned long) env->resources.peak_untyped);
+    }
+
+    for (int i = 0; i < seL4_ObjectTypeCount; i++) {
+        if (env->resources.peak_objects[i] == 0) {
+            continue;
+        }
+        if (config_set(CONFIG_PRINT_XML)) {
+            printf("\t\t\t<property name=\"peak_untyped_type%d\" value=\"%lu\"/>\n", i,
+                   (unsigned long) env->resources.peak_objects[i]);
+        } else {
+            printf("\t\tobject type %d: peak %lu bytes\n", i, (unsigned long) env->resources.peak_objects[i]);
+        }
+    }
+}
+#endif /* CONFIG_SEL4TEST_REPORT_RESOURCES */
+
+void benchmark_init(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    kernel_entries_init(env);
+#endif
+}
+
+void benchmark_start_test(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    kernel_entries_start(env);
+    seL4_BenchmarkResetLog();
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    utilisation_start(env);
+#endif
+}
+
+void benchmark_end_test(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    kernel_entries_end(env, seL4_BenchmarkFinalizeLog());
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    utilisation_end(env);
+#endif
+}
+
+void benchmark_read_result(UNUSED driver_env_t env, UNUSED seL4_MessageInfo_t info)
+{
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+    resources_read(env, info);
+#endif
+}
+
+void benchmark_report_test(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+    resources_report(env);
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    kernel_entries_report(env);
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    utilisation_report(env);
+#endif
+}
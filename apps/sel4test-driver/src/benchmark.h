@@ -0,0 +1,26 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include "test.h"
+
+/* Per test measurements used only by sel4test-driver. The kernel ones use the
+ * kernel benchmark API and do nothing unless the kernel was built with the
+ * matching CONFIG_BENCHMARK_* option. The resources used by each test process
+ * are reported with CONFIG_SEL4TEST_REPORT_RESOURCES. */
+
+/* called once before any tests are run */
+void benchmark_init(driver_env_t env);
+/* called just before the test process is started */
+void benchmark_start_test(driver_env_t env);
+/* called once the test process has reported its result, before it is destroyed */
+void benchmark_end_test(driver_env_t env);
+/* called with the result message of a test that did not fault */
+void benchmark_read_result(driver_env_t env, seL4_MessageInfo_t info);
+/* print what was collected for the last test as part of its report. With
+ * CONFIG_PRINT_XML this, and the other per test reports, only print property
+ * lines, sel4test_end_test prints the properties element around them */
+void benchmark_report_test(driver_env_t env);
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+#include <stdio.h>
+#include <string.h>
+#include <utils/util.h>
+
+#include "budget.h"
+#include "timer.h"
+
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+/* tests over budget that are named in the summary, the rest are only counted */
+#define MAX_LISTED_OVER_BUDGET 32
+
+static struct {
+    test_budget_t *test_budgets;
+    int num_test_budgets;
+
+    /* the last test */
+    const char *name;
+    uint64_t start;
+    uint64_t duration_ns;
+    seL4_Word budget_ms;
+    bool valid;
+
+    struct {
+        const char *name;
+        uint64_t duration_ns;
+        seL4_Word budget_ms;
+    } over[MAX_LISTED_OVER_BUDGET];
+    int num_over;
+} budgets;
+
+/* The length of the part of name that budget applies to: all of it, or the
+ * part before the suffix added by DEFINE_TEST_PARAM. 0 if it does not apply. */
+static size_t budget_match(test_budget_t *budget, const char *name)
+{
+    size_t len = strnlen(budget->name, TEST_NAME_MAX);
+    if (strncmp(budget->name, name, len) == 0 && (name[len] == '\0' || name[len] == '_')) {
+        return len;
+    }
+    return 0;
+}
+
+/* the budget that matches the most of name, or NULL */
+static test_budget_t *find_budget(test_budget_t *table, int num, const char *name, size_t *best_len)
+{
+    test_budget_t *best = NULL;
+    for (int i = 0; i < num; i++) {
+        size_t len = budget_match(&table[i], name);
+        if (len > *best_len) {
+            *best_len = len;
+            best = &table[i];
+        }
+    }
+    return best;
+}
+
+static seL4_Word default_budget_ms(testcase_t *test)
+{
+    switch (test->test_type) {
+    case BOOTSTRAP:
+        return CONFIG_SEL4TEST_BUDGET_BOOTSTRAP_MS;
+    default:
+        return CONFIG_SEL4TEST_BUDGET_BASIC_MS;
+    }
+}
+
+static seL4_Word test_budget_ms(testcase_t *test)
+{
+    size_t len = 0;
+    test_budget_t *budget = find_budget(__start__test_budget, __stop__test_budget - __start__test_budget,
+                                        test->name, &len);
+    test_budget_t *tests_budget = find_budget(budgets.test_budgets, budgets.num_test_budgets, test->name, &len);
+    if (tests_budget != NULL) {
+        budget = tests_budget;
+    }
+    if (budget == NULL) {
+        return default_budget_ms(test);
+    }
+    if (budget->scale == TEST_BUDGET_SCALED) {
+        return MAX(budget->budget_ms / CONFIG_SEL4TEST_TIME_SCALE, default_budget_ms(test));
+    }
+    return budget->budget_ms;
+}
+#endif /* CONFIG_SEL4TEST_DURATION_BUDGETS */
+
+void budget_init(UNUSED test_budget_t *test_budgets, UNUSED int num_test_budgets)
+{
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+    budgets.test_budgets = test_budgets;
+    budgets.num_test_budgets = num_test_budgets;
+#endif
+}
+
+void budget_start_test(UNUSED driver_env_t env, UNUSED testcase_t *test)
+{
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+    if (!config_set(CONFIG_HAVE_TIMER)) {
+        return;
+    }
+    budgets.name = test->name;
+    budgets.budget_ms = test_budget_ms(test);
+    budgets.start = timestamp(env);
+#endif
+}
+
+void budget_end_test(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+    if (!config_set(CONFIG_HAVE_TIMER)) {
+        return;
+    }
+    budgets.duration_ns = timestamp(env) - budgets.start;
+    budgets.valid = true;
+#endif
+}
+
+void budget_report_test(void)
+{
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+    if (!budgets.valid) {
+        return;
+    }
+    budgets.valid = false;
+
+    uint64_t budget_ns = (uint64_t) budgets.budget_ms * NS_IN_MS;
+    bool over = budgets.duration_ns > budget_ns * CONFIG_SEL4TEST_BUDGET_FACTOR;
+    if (over) {
+        if (budgets.num_over < MAX_LISTED_OVER_BUDGET) {
+            budgets.over[budgets.num_over].name = budgets.name;
+            budgets.over[budgets.num_over].duration_ns = budgets.duration_ns;
+            budgets.over[budgets.num_over].budget_ms = budgets.budget_ms;
+        }
+        budgets.num_over++;
+    }
+
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"duration_us\" value=\"%llu\"/>\n",
+               (unsigned long long) budgets.duration_ns / NS_IN_US);
+        printf("\t\t\t<property name=\"budget_ms\" value=\"%lu\"/>\n", (unsigned long) budgets.budget_ms);
+        if (over) {
+            printf("\t\t\t<property name=\"over_budget\" value=\"true\"/>\n");
+        }
+    } else {
+        printf("\tDuration: %llu us, budget %lu ms%s\n", (unsigned long long) budgets.duration_ns / NS_IN_US,
+               (unsigned long) budgets.budget_ms, over ? ", OVER BUDGET" : "");
+    }
+#endif
+}
+
+void budget_report_suite(void)
+{
+#ifdef CONFIG_SEL4TEST_DURATION_BUDGETS
+    if (budgets.num_over == 0) {
+        return;
+    }
+
+    printf("%d tests took more than %d times their budget:\n", budgets.num_over, CONFIG_SEL4TEST_BUDGET_FACTOR);
+    for (int i = 0; i < MIN(budgets.num_over, MAX_LISTED_OVER_BUDGET); i++) {
+        printf("\t%s: %llu us, budget %lu ms\n", budgets.over[i].name,
+               (unsigned long long) budgets.over[i].duration_ns / NS_IN_US, (unsigned long) budgets.over[i].budget_ms);
+    }
+    if (budgets.num_over > MAX_LISTED_OVER_BUDGET) {
+        printf("\tand %d more\n", budgets.num_over - MAX_LISTED_OVER_BUDGET);
+    }
+#endif
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include "test.h"
+
+/* Checking how long each test takes against its budget (enabled by
+ * CONFIG_SEL4TEST_DURATION_BUDGETS). Budgets are set with DEFINE_TEST_BUDGET, in
+ * the driver or in sel4test-tests, and otherwise default by test type. */
+
+/* called once before any tests are run, with the budgets defined in sel4test-tests */
+void budget_init(test_budget_t *test_budgets, int num_test_budgets);
+/* called just before a test is set up */
+void budget_start_test(driver_env_t env, testcase_t *test);
+/* called once the test has been torn down */
+void budget_end_test(driver_env_t env);
+/* print the duration and budget of the last test as part of its report */
+void budget_report_test(void);
+/* list the tests that went over their budget, at the end of the run */
+void budget_report_suite(void);
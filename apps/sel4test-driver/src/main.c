@@ -45,6 +45,9 @@
 #include <vspace/vspace.h>
 #include "test.h"
 #include "timer.h"
+#include "benchmark.h"
+#include "budget.h"
+#include "revoke.h"
 
 #include <sel4platsupport/io.h>
 
@@ -68,8 +71,6 @@ static sel4utils_alloc_data_t data;
 struct driver_env env;
 /* list of untypeds to give out to test processes */
 static vka_object_t untypeds[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
-/* list of sizes (in bits) corresponding to untyped */
-static uint8_t untyped_size_bits_list[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
 
 extern char _cpio_archive[];
 extern char _cpio_archive_end[];
@@ -83,12 +84,29 @@ static void init_env(driver_env_t env)
     reservation_t virtual_reservation;
     int error;
 
+    /* split the untypeds between us and the tests, before the allocator is
+     * created so that it only knows about ours */
+    seL4_CPtr first_free_slot = partition_untypeds(env);
+    env->untypeds = untypeds;
+
     /* create an allocator */
-    allocman = bootstrap_use_current_simple(&env->simple, ALLOCATOR_STATIC_POOL_SIZE, allocator_mem_pool);
+    size_t cnode_size_bits = simple_get_cnode_size_bits(&env->simple);
+    allocman = bootstrap_use_current_1level(simple_get_cnode(&env->simple), cnode_size_bits, first_free_slot,
+                                            BIT(cnode_size_bits), ALLOCATOR_STATIC_POOL_SIZE, allocator_mem_pool);
     if (allocman == NULL) {
         ZF_LOGF("Failed to create allocman");
     }
 
+    for (int i = 0; i < num_driver_untypeds; i++) {
+        cspacepath_t path = allocman_cspace_make_path(allocman, driver_untypeds[i].cptr);
+        error = allocman_utspace_add_uts(allocman, 1, &path, &driver_untypeds[i].size_bits,
+                                         &driver_untypeds[i].paddr,
+                                         driver_untypeds[i].device ? ALLOCMAN_UT_DEV : ALLOCMAN_UT_KERNEL);
+        if (error) {
+            ZF_LOGF("Failed to add untypeds to allocman");
+        }
+    }
+
     /* create a vka (interface for interacting with the underlying allocator) */
     allocman_make_vka(&env->vka, allocman);
 
@@ -117,58 +135,133 @@ static void init_env(driver_env_t env)
     ZF_LOGF_IF(error, "Failed to initialise IO ops");
 }
 
-/* Free a list of objects */
-static void free_objects(vka_object_t *objects, unsigned int num)
+/* An untyped from bootinfo, or one split from it, while the memory is being
+ * partitioned between the driver and the tests */
+typedef struct boot_untyped {
+    seL4_CPtr cptr;
+    size_t size_bits;
+    uintptr_t paddr;
+    bool device;
+} boot_untyped_t;
+
+/* Untypeds kept by the driver: every device untyped, the reserved RAM and any
+ * RAM that does not fit in the list of untypeds for the tests */
+static boot_untyped_t driver_untypeds[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS + seL4_WordBits];
+static int num_driver_untypeds;
+
+static void give_to_driver(boot_untyped_t ut)
 {
-    for (unsigned int i = 0; i < num; i++) {
-        vka_free_object(&env.vka, &objects[i]);
+    assert(num_driver_untypeds < ARRAY_SIZE(driver_untypeds));
+    driver_untypeds[num_driver_untypeds++] = ut;
+}
+
+static void give_to_tests(driver_env_t env, boot_untyped_t ut)
+{
+    if (env->num_untypeds == ARRAY_SIZE(untypeds)) {
+        give_to_driver(ut);
+        return;
     }
+    untypeds[env->num_untypeds] = (vka_object_t) {
+        .cptr = ut.cptr,
+        .type = seL4_UntypedObject,
+        .size_bits = ut.size_bits
+    };
+    env->num_untypeds++;
 }
 
-/* Allocate untypeds till either a certain number of bytes is allocated
- * or a certain number of untyped objects */
-static unsigned int allocate_untypeds(vka_object_t *untypeds, size_t bytes, unsigned int max_untypeds)
+/* Split an untyped so that its first BIT(size_bits) bytes go to the driver and the
+ * rest to the tests. The children are retyped smallest first, so each is naturally
+ * aligned and together they cover the whole untyped. Returns the next free slot. */
+static seL4_CPtr split_untyped(driver_env_t env, boot_untyped_t ut, size_t size_bits, seL4_CPtr free_slot)
 {
-    unsigned int num_untypeds = 0;
-    size_t allocated = 0;
-
-    /* try to allocate as many of each possible untyped size as possible */
-    for (uint8_t size_bits = seL4_WordBits - 1; size_bits > PAGE_BITS_4K; size_bits--) {
-        /* keep allocating until we run out, or if allocating would
-         * cause us to allocate too much memory*/
-        while (num_untypeds < max_untypeds &&
-               allocated + BIT(size_bits) <= bytes &&
-               vka_alloc_untyped(&env.vka, size_bits, &untypeds[num_untypeds]) == 0) {
-            allocated += BIT(size_bits);
-            num_untypeds++;
+    uintptr_t paddr = ut.paddr;
+    bool driver = true;
+
+    for (size_t child_bits = size_bits; child_bits < ut.size_bits; child_bits++) {
+        /* there are two children of the smallest size, one for each side */
+        for (int i = (child_bits == size_bits) ? 0 : 1; i < 2; i++) {
+            UNUSED int error = seL4_Untyped_Retype(ut.cptr, seL4_UntypedObject, child_bits,
+                                                   simple_get_cnode(&env->simple), 0, 0, free_slot, 1);
+            ZF_LOGF_IF(error, "Failed to split untyped");
+            boot_untyped_t child = { .cptr = free_slot, .size_bits = child_bits, .paddr = paddr };
+            if (driver) {
+                give_to_driver(child);
+                driver = false;
+            } else {
+                give_to_tests(env, child);
+            }
+            paddr += BIT(child_bits);
+            free_slot++;
         }
     }
-    return num_untypeds;
+    return free_slot;
 }
 
-/* extract a large number of untypeds from the allocator */
-static unsigned int populate_untypeds(vka_object_t *untypeds)
+/* Decide which bootinfo untypeds the driver keeps and which are given to the
+ * tests, straight from the list in simple. The driver keeps the device untypeds
+ * and DRIVER_UNTYPED_MEMORY of RAM, taken from the smallest untypeds first, and
+ * splits the untyped that takes it over the limit. The tests get the rest whole.
+ * Returns the first slot not used for splitting. */
+static seL4_CPtr partition_untypeds(driver_env_t env)
 {
-    /* First reserve some memory for the driver */
-    vka_object_t reserve[DRIVER_NUM_UNTYPEDS];
-    unsigned int reserve_num = allocate_untypeds(reserve, DRIVER_UNTYPED_MEMORY, DRIVER_NUM_UNTYPEDS);
+    /* static, as this runs on the small initial stack */
+    static boot_untyped_t ram[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
+    int count = simple_get_untyped_count(&env->simple);
+    int num_ram = 0;
+
+    assert(count <= ARRAY_SIZE(ram));
+
+    for (int i = 0; i < count; i++) {
+        boot_untyped_t ut = {0};
+        ut.cptr = simple_get_nth_untyped(&env->simple, i, &ut.size_bits, &ut.paddr, &ut.device);
+        if (ut.device) {
+            give_to_driver(ut);
+            continue;
+        }
+        /* keep the RAM sorted by size, smallest first */
+        int j;
+        for (j = num_ram; j > 0 && ram[j - 1].size_bits > ut.size_bits; j--) {
+            ram[j] = ram[j - 1];
+        }
+        ram[j] = ut;
+        num_ram++;
+    }
 
-    /* Now allocate everything else for the tests */
-    unsigned int num_untypeds = allocate_untypeds(untypeds, UINT_MAX, ARRAY_SIZE(untyped_size_bits_list));
-    /* Fill out the size_bits list */
-    for (unsigned int i = 0; i < num_untypeds; i++) {
-        untyped_size_bits_list[i] = untypeds[i].size_bits;
+    /* reserve the driver's memory from the smallest untypeds */
+    size_t reserved = 0;
+    int next = 0;
+    while (next < num_ram && reserved + BIT(ram[next].size_bits) <= DRIVER_UNTYPED_MEMORY) {
+        reserved += BIT(ram[next].size_bits);
+        give_to_driver(ram[next++]);
     }
 
-    /* Return reserve memory */
-    free_objects(reserve, reserve_num);
+    /* the tests get the largest untypeds first */
+    env->num_untypeds = 0;
+    for (int i = num_ram - 1; i > next; i--) {
+        give_to_tests(env, ram[i]);
+    }
 
-    /* Return number of untypeds for tests */
-    if (num_untypeds == 0) {
-        ZF_LOGF("No untypeds for tests!");
+    seL4_CPtr free_slot = simple_last_valid_cap(&env->simple) + 1;
+    if (next < num_ram) {
+        if (reserved < DRIVER_UNTYPED_MEMORY) {
+            /* ram[next] is bigger than what is still needed, so take the smallest
+             * power of two that covers it and give the remainder to the tests */
+            size_t needed = DRIVER_UNTYPED_MEMORY - reserved;
+            size_t size_bits = MAX(LOG_BASE_2(needed) + (IS_POWER_OF_2(needed) ? 0 : 1), PAGE_BITS_4K);
+            if (size_bits < ram[next].size_bits) {
+                free_slot = split_untyped(env, ram[next], size_bits, free_slot);
+            } else {
+                give_to_driver(ram[next]);
+            }
+        } else {
+            give_to_tests(env, ram[next]);
+        }
     }
 
-    return num_untypeds;
+    if (env->num_untypeds == 0) {
+        ZF_LOGF("No untypeds for tests!");
+    }
+    return free_slot;
 }
 
 static void init_timer(void)
@@ -191,6 +284,19 @@ static void init_timer(void)
     }
 }
 
+/* Boot phases are timed from when the timer is up, the phases before that
+ * (allocator, serial and timer set up) can not be timed. */
+static uint64_t boot_phase_start;
+
+static void boot_phase_done(const char *phase)
+{
+    if (config_set(CONFIG_HAVE_TIMER)) {
+        uint64_t now = timestamp(&env);
+        printf("Boot phase %s took %llu us\n", phase, (unsigned long long)(now - boot_phase_start) / NS_IN_US);
+        boot_phase_start = now;
+    }
+}
+
 void sel4test_start_suite(const char *name)
 {
     if (config_set(CONFIG_PRINT_XML)) {
@@ -211,11 +317,30 @@ void sel4test_start_test(const char *name, int n)
     sel4test_start_printf_buffer();
 }
 
+/* Are any of the per test reports built in, which print properties of the test case */
+#define REPORTS_PROPERTIES (config_set(CONFIG_BENCHMARK_TRACK_UTILISATION) || \
+                            config_set(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || \
+                            config_set(CONFIG_SEL4TEST_REPORT_RESOURCES) || \
+                            config_set(CONFIG_SEL4TEST_BACKGROUND_REVOKE) || \
+                            config_set(CONFIG_SEL4TEST_DURATION_BUDGETS))
+
 void sel4test_end_test(test_result_t result)
 {
     sel4test_end_printf_buffer();
     test_check(result == SUCCESS);
 
+    /* A test case can only have one properties element, so the reports below
+     * only print the property lines in it */
+    if (config_set(CONFIG_PRINT_XML) && REPORTS_PROPERTIES) {
+        printf("\t\t<properties>\n");
+    }
+    benchmark_report_test(&env);
+    revoke_report_test(&env);
+    budget_report_test();
+    if (config_set(CONFIG_PRINT_XML) && REPORTS_PROPERTIES) {
+        printf("\t\t</properties>\n");
+    }
+
     if (config_set(CONFIG_PRINT_XML)) {
         printf("\t</testcase>\n");
     }
@@ -265,6 +390,7 @@ void sel4test_stop_tests(test_result_t result, int tests_done, int tests_failed,
     sel4test_end_test(sel4test_get_result());
 
     sel4test_end_suite(tests_done, tests_done - tests_failed, skipped_tests);
+    budget_report_suite();
 
     if (tests_failed > 0) {
         printf("*** FAILURES DETECTED ***\n");
@@ -276,15 +402,134 @@ void sel4test_stop_tests(test_result_t result, int tests_done, int tests_failed,
     printf("\n\n");
 }
 
-static int collate_tests(testcase_t *tests_in, int n, testcase_t *tests_out[], int out_index,
-                         regex_t *reg, int *skipped_tests)
+/* longest selection line read from the console */
+#define SELECTION_MAX 128
+
+#ifdef CONFIG_SEL4TEST_CONSOLE_SELECT
+/* from sel4platsupport, returns -1 if no character is waiting */
+extern int __arch_getchar(void);
+#endif
+
+/* Which tests to run, from the build configuration unless read_selection gets
+ * something else from the console. */
+static struct {
+    const char *regex;
+    /* run every num_shards'th selected test, starting with the shard'th */
+    int shard;
+    int num_shards;
+    /* skip the tests numbered below this */
+    int start;
+} selection;
+
+#ifdef CONFIG_SEL4TEST_CONSOLE_SELECT
+/* read a line, giving up once nothing has been received for the window */
+static int read_selection_line(char *line, int max)
+{
+    int len = 0;
+    uint64_t deadline = timestamp(&env) + CONFIG_SEL4TEST_CONSOLE_SELECT_WINDOW * NS_IN_MS;
+
+    while (timestamp(&env) < deadline) {
+        int c = __arch_getchar();
+        if (c < 0) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            break;
+        }
+        if (len < max - 1) {
+            line[len++] = c;
+        }
+        deadline = timestamp(&env) + CONFIG_SEL4TEST_CONSOLE_SELECT_WINDOW * NS_IN_MS;
+    }
+    line[len] = '\0';
+    return len;
+}
+
+/* the selection points into line, which must stay around */
+static void parse_selection(char *line)
 {
+    for (char *word = strtok(line, " "); word != NULL; word = strtok(NULL, " ")) {
+        int shard, num_shards, start;
+        /* how much of word was parsed, so that trailing characters are rejected */
+        int len = 0;
+        if (strncmp(word, "regex=", strlen("regex=")) == 0) {
+            selection.regex = word + strlen("regex=");
+        } else if (sscanf(word, "shard=%d/%d%n", &shard, &num_shards, &len) == 2 && word[len] == '\0' &&
+                   num_shards > 0 && shard >= 0 && shard < num_shards) {
+            selection.shard = shard;
+            selection.num_shards = num_shards;
+        } else if (sscanf(word, "start=%d%n", &start, &len) == 1 && word[len] == '\0' && start >= 0) {
+            selection.start = start;
+        } else {
+            printf("Ignoring test selection \"%s\"\n", word);
+        }
+    }
+}
+#endif /* CONFIG_SEL4TEST_CONSOLE_SELECT */
+
+static void read_selection(void)
+{
+    selection.regex = CONFIG_TESTPRINTER_REGEX;
+    selection.shard = 0;
+    selection.num_shards = 1;
+    selection.start = CONFIG_SEL4TEST_START_INDEX;
+
+#ifdef CONFIG_SEL4TEST_CONSOLE_SELECT
+    if (config_set(CONFIG_HAVE_TIMER)) {
+        static char line[SELECTION_MAX];
+        printf("Enter test selection within %d ms (regex=<regex> shard=<i>/<n> start=<n>):\n",
+               CONFIG_SEL4TEST_CONSOLE_SELECT_WINDOW);
+        if (read_selection_line(line, sizeof(line)) > 0) {
+            parse_selection(line);
+        }
+        printf("Running tests matching \"%s\", shard %d/%d\n", selection.regex, selection.shard,
+               selection.num_shards);
+    }
+#endif
+    /* tools/resume-tests.py relies on this to number the tests in the log */
+    if (selection.start > 0) {
+        printf("Starting from test %d\n", selection.start);
+    }
+}
+
+/* Find the tests of the tests app in order of name, from the manifest built
+ * with it by tools/test-manifest.py, which holds the offset of each test in its
+ * _test_case section. */
+static void order_app_tests(testcase_t *tests_in, int n, testcase_t *tests_out[])
+{
+    unsigned long manifest_size = 0;
+    unsigned long cpio_len = _cpio_archive_end - _cpio_archive;
+    const uint32_t *manifest = cpio_get_file(_cpio_archive, cpio_len, TESTS_MANIFEST, &manifest_size);
+    ZF_LOGF_IF(manifest == NULL, "Error: failed to lookup test manifest");
+    ZF_LOGF_IF(manifest_size != n * sizeof(uint32_t), "Test manifest does not match "TESTS_APP);
+
     for (int i = 0; i < n; i++) {
+        ZF_LOGF_IF(manifest[i] % sizeof(testcase_t) != 0 || manifest[i] / sizeof(testcase_t) >= (size_t) n,
+                   "Test manifest does not match "TESTS_APP);
+        tests_out[i] = &tests_in[manifest[i] / sizeof(testcase_t)];
         /* make sure the string is null terminated */
-        tests_in[i].name[TEST_NAME_MAX - 1] = '\0';
-        if (regexec(reg, tests_in[i].name, 0, NULL, 0) == 0) {
-            if (tests_in[i].enabled) {
-                tests_out[out_index] = &tests_in[i];
+        tests_out[i]->name[TEST_NAME_MAX - 1] = '\0';
+    }
+}
+
+/* Merge the tests of the driver and of the tests app, both sorted by name, into
+ * the tests that are selected. No two tests have the same name, that is checked
+ * when the driver is built. */
+static int collate_tests(testcase_t *driver_tests[], int num_driver_tests, testcase_t *app_tests[],
+                         int num_app_tests, testcase_t *tests_out[], regex_t *reg, int *skipped_tests)
+{
+    int out_index = 0;
+    int d = 0, a = 0;
+    while (d < num_driver_tests || a < num_app_tests) {
+        testcase_t *test;
+        if (a == num_app_tests || (d < num_driver_tests && strcmp(driver_tests[d]->name, app_tests[a]->name) < 0)) {
+            test = driver_tests[d++];
+        } else {
+            test = app_tests[a++];
+        }
+        if (regexec(reg, test->name, 0, NULL, 0) == 0) {
+            if (test->enabled) {
+                tests_out[out_index] = test;
                 out_index++;
             } else {
                 (*skipped_tests)++;
@@ -317,32 +562,51 @@ void sel4test_run_tests(struct driver_env *e)
         ZF_LOGF(TESTS_APP": Failed to find section: _test_case");
     }
     int tc_tests = tc_size / sizeof(testcase_t);
+    e->test_cases = sel4test_tests;
+    e->num_test_cases = tc_tests;
+
+    uint64_t budgets_size = 0;
+    test_budget_t *budgets = (test_budget_t *) sel4utils_elf_get_section(&tests_elf, "_test_budget", &budgets_size);
+    budget_init(budgets, budgets_size / sizeof(test_budget_t));
     int all_tests = driver_tests + tc_tests;
     testcase_t *tests[all_tests];
 
+    /* The tests are run in order of name, to remove any non determinism in test
+     * ordering. The tests app is sorted when it is built, only the few tests of
+     * the driver itself are sorted here. */
+    testcase_t *sorted_driver_tests[driver_tests];
+    for (int i = 0; i < driver_tests; i++) {
+        /* make sure the string is null terminated */
+        __start__test_case[i].name[TEST_NAME_MAX - 1] = '\0';
+        sorted_driver_tests[i] = &__start__test_case[i];
+    }
+    qsort(sorted_driver_tests, driver_tests, sizeof(testcase_t *), test_comparator);
+    testcase_t *sorted_app_tests[tc_tests];
+    order_app_tests(sel4test_tests, tc_tests, sorted_app_tests);
+
     /* Extract and filter the tests based on the regex */
+    read_selection();
     regex_t reg;
-    int error = regcomp(&reg, CONFIG_TESTPRINTER_REGEX, REG_EXTENDED | REG_NOSUB);
-    ZF_LOGF_IF(error, "Error compiling regex \"%s\"\n", CONFIG_TESTPRINTER_REGEX);
+    int error = regcomp(&reg, selection.regex, REG_EXTENDED | REG_NOSUB);
+    ZF_LOGF_IF(error, "Error compiling regex \"%s\"\n", selection.regex);
 
     int skipped_tests = 0;
-    /* get all the tests in the test case section in the driver */
-    int num_tests = collate_tests(__start__test_case, driver_tests, tests, 0, &reg, &skipped_tests);
-    /* get all the tests in the sel4test_tests app */
-    num_tests = collate_tests(sel4test_tests, tc_tests, tests, num_tests, &reg, &skipped_tests);
+    int num_tests = collate_tests(sorted_driver_tests, driver_tests, sorted_app_tests, tc_tests, tests, &reg,
+                                  &skipped_tests);
 
     /* finished with regex */
     regfree(&reg);
 
-    /* Sort the tests to remove any non determinism in test ordering */
-    qsort(tests, num_tests, sizeof(testcase_t *), test_comparator);
-
-    /* Now that they are sorted we can easily ensure there are no duplicate tests.
-     * this just ensures some sanity as if there are duplicates, they could have some
-     * arbitrary ordering, which might result in difficulty reproducing test failures */
-    for (int i = 1; i < num_tests; i++) {
-        ZF_LOGF_IF(strcmp(tests[i]->name, tests[i - 1]->name) == 0, "tests have no strict order! %s %s",
-                   tests[i]->name, tests[i - 1]->name);
+    /* keep only our shard, it is taken from the sorted list so that the shards of
+     * the same selection never overlap */
+    if (selection.num_shards > 1) {
+        int kept = 0;
+        for (int i = 0; i < num_tests; i++) {
+            if (i % selection.num_shards == selection.shard) {
+                tests[kept++] = tests[i];
+            }
+        }
+        num_tests = kept;
     }
 
     /* Check that we don't miss any tests because of an undeclared test type */
@@ -366,16 +630,33 @@ void sel4test_run_tests(struct driver_env *e)
 
         for (int i = 0; i < num_tests; i++) {
             if (tests[i]->test_type == test_types[tt]->id) {
+                if (tests_done < selection.start) {
+                    /* counted as done, so that the test numbers match a full run */
+                    tests_done++;
+                    continue;
+                }
                 sel4test_start_test(tests[i]->name, tests_done);
+                budget_start_test(e, tests[i]);
                 if (test_types[tt]->set_up != NULL) {
                     test_types[tt]->set_up((uintptr_t)e);
                 }
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+                /* the process for the next test can be prepared during this one */
+                e->prespawn.wanted = false;
+                for (int j = i + 1; j < num_tests; j++) {
+                    if (test_types[tt]->id == BASIC && tests[j]->test_type == BASIC) {
+                        e->prespawn.wanted = true;
+                        break;
+                    }
+                }
+#endif
 
                 test_result_t result = test_types[tt]->run_test(tests[i], (uintptr_t)e);
 
                 if (test_types[tt]->tear_down != NULL) {
                     test_types[tt]->tear_down((uintptr_t)e);
                 }
+                budget_end_test(e);
                 sel4test_end_test(result);
 
                 if (result != SUCCESS) {
@@ -412,12 +693,17 @@ void *main_continued(void *arg UNUSED)
     ZF_LOGF_IF(elf_file == NULL, "Error: failed to lookup ELF file");
     int status = elf_newFile(elf_file, elf_size, &tests_elf);
     ZF_LOGF_IF(status, "Error: invalid ELF file");
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+    ZF_LOGW_IF((uintptr_t) elf_file % PAGE_SIZE_4K != 0, "Tests ELF is not page aligned, it will be copied");
+    env.tests_elf = &tests_elf;
+#endif
 
     /* Print welcome banner. */
     printf("\n");
     printf("seL4 Test\n");
     printf("=========\n");
     printf("\n");
+    boot_phase_done("stack switch and tests elf");
 
     int error;
 
@@ -441,19 +727,21 @@ void *main_continued(void *arg UNUSED)
             }
         }
         ZF_LOGF_IF(allocated == false, "Failed to allocate a device frame for the frame tests");
+        boot_phase_done("device frame");
     }
 
-    /* allocate lots of untyped memory for tests to use */
-    env.num_untypeds = populate_untypeds(untypeds);
-    env.untypeds = untypeds;
-
     /* create a frame that will act as the init data, we can then map that
      * in to target processes */
     env.init = (test_init_data_t *) vspace_new_pages(&env.vspace, seL4_AllRights, 1, PAGE_BITS_4K);
     assert(env.init != NULL);
-
-    /* copy the untyped size bits list across to the init frame */
-    memcpy(env.init->untyped_size_bits_list, untyped_size_bits_list, sizeof(uint8_t) * env.num_untypeds);
+    env.test_process = &env.test_processes[0];
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+    /* a second init data frame for the test process prepared in advance, the two
+     * frames alternate between tests */
+    env.prespawn.init = (test_init_data_t *) vspace_new_pages(&env.vspace, seL4_AllRights, 1, PAGE_BITS_4K);
+    assert(env.prespawn.init != NULL);
+    env.prespawn.test_process = &env.test_processes[1];
+#endif
 
     /* parse elf region data about the test image to pass to the tests app */
     num_elf_regions = sel4utils_elf_num_regions(&tests_elf);
@@ -466,6 +754,7 @@ void *main_continued(void *arg UNUSED)
 
     /* setup init data that won't change test-to-test */
     env.init->priority = seL4_MaxPrio - 1;
+    env.init->time_scale = CONFIG_SEL4TEST_TIME_SCALE;
     if (plat_init) {
         plat_init(&env);
     }
@@ -476,6 +765,13 @@ void *main_continued(void *arg UNUSED)
         ZF_LOGF_IF(error, "Failed to allocate reply");
     }
 
+    boot_phase_done("init data");
+
+    benchmark_init(&env);
+    boot_phase_done("benchmark");
+
+    revoke_init(&env);
+
     /* now run the tests */
     sel4test_run_tests(&env);
 
@@ -644,6 +940,9 @@ int main(void)
     init_timer();
     /* Restore the IRQ interface's register function */
     env.ops.irq_ops.irq_register_fn = irq_register_fn_copy;
+    if (config_set(CONFIG_HAVE_TIMER)) {
+        boot_phase_start = timestamp(&env);
+    }
 
     simple_print(&env.simple);
 
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+#include <assert.h>
+#include <stdio.h>
+#include <sel4/sel4.h>
+#include <sel4utils/thread.h>
+#include <utils/util.h>
+#include <vka/capops.h>
+
+#include "revoke.h"
+#include "timer.h"
+
+static void revoke_pool(driver_env_t env, vka_object_t *untypeds, int num_untypeds)
+{
+    for (int i = 0; i < num_untypeds; i++) {
+        cspacepath_t path;
+        vka_cspace_make_path(&env->vka, untypeds[i].cptr, &path);
+        vka_cnode_revoke(&path);
+    }
+}
+
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+/* The worker runs at the lowest priority, so that it does not preempt any thread
+ * of a test, helpers included, and only gets the time the tests leave idle. It
+ * is raised to REVOKE_WORKER_WAIT_PRIO while the driver waits for it. */
+#define REVOKE_WORKER_PRIO seL4_MinPrio
+#define REVOKE_WORKER_WAIT_PRIO seL4_MaxPrio
+
+static void revoke_worker(void *arg0, UNUSED void *arg1, UNUSED void *ipc_buf)
+{
+    driver_env_t env = arg0;
+
+    /* The worker does not allocate anything, and making paths in revoke_pool
+     * only reads the allocator, so it does not race with the driver. It does not
+     * use the timer either, as the driver may be in the middle of using it, so
+     * the revoke is only timed by the driver. */
+    while (1) {
+        seL4_Word badge;
+        seL4_Wait(env->revoke.request.cptr, &badge);
+        for (int pool = 0; pool < 2; pool++) {
+            if (badge & BIT(pool)) {
+                revoke_pool(env, &env->untypeds[env->revoke.start[pool]], env->revoke.num[pool]);
+                seL4_Signal(env->revoke.done_caps[pool]);
+            }
+        }
+    }
+}
+
+static seL4_CPtr mint_badged(driver_env_t env, vka_object_t *ntfn, seL4_Word badge)
+{
+    cspacepath_t src, dest;
+    vka_cspace_make_path(&env->vka, ntfn->cptr, &src);
+    int error = vka_cspace_alloc_path(&env->vka, &dest);
+    ZF_LOGF_IF(error, "Failed to allocate slot for badged notification");
+    error = vka_cnode_mint(&dest, &src, seL4_AllRights, badge);
+    ZF_LOGF_IF(error, "Failed to mint badged notification");
+    return dest.capPtr;
+}
+
+/* Split the untypeds, which are sorted largest first, into two pools of about
+ * the same size. The untypeds are reordered so that each pool is contiguous. */
+static void split_pools(driver_env_t env)
+{
+    static vka_object_t pools[2][CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
+    size_t pool_bytes[2] = {0};
+
+    env->revoke.num[0] = env->revoke.num[1] = 0;
+    for (int i = 0; i < env->num_untypeds; i++) {
+        int pool = pool_bytes[0] <= pool_bytes[1] ? 0 : 1;
+        pools[pool][env->revoke.num[pool]++] = env->untypeds[i];
+        pool_bytes[pool] += BIT(env->untypeds[i].size_bits);
+    }
+    ZF_LOGF_IF(env->revoke.num[1] == 0, "Not enough untypeds to split for background revoke");
+
+    for (int pool = 0; pool < 2; pool++) {
+        env->revoke.start[pool] = pool == 0 ? 0 : env->revoke.num[0];
+        for (int i = 0; i < env->revoke.num[pool]; i++) {
+            env->untypeds[env->revoke.start[pool] + i] = pools[pool][i];
+        }
+    }
+    /* the first test gets pool 0 */
+    env->revoke.current = 1;
+}
+
+/* Wait for the worker to finish revoking a pool. Returns how long we waited,
+ * and sets *revoke_ns to how long after being asked the revoke was seen to be
+ * done, which is longer than it took if it finished before we got here. */
+static uint64_t wait_pool(driver_env_t env, int pool, uint64_t *revoke_ns)
+{
+    *revoke_ns = 0;
+    if (!(env->revoke.pending & BIT(pool))) {
+        return 0;
+    }
+
+    uint64_t start = config_set(CONFIG_HAVE_TIMER) ? timestamp(env) : 0;
+    /* nothing else needs the cpu while we wait */
+    int error = seL4_TCB_SetPriority(env->revoke.worker.tcb.cptr, simple_get_tcb(&env->simple),
+                                     REVOKE_WORKER_WAIT_PRIO);
+    ZF_LOGF_IF(error, "Failed to raise revoke worker priority");
+    while (env->revoke.pending & BIT(pool)) {
+        seL4_Word badge;
+        seL4_Wait(env->revoke.done.cptr, &badge);
+        env->revoke.pending &= ~badge;
+    }
+    error = seL4_TCB_SetPriority(env->revoke.worker.tcb.cptr, simple_get_tcb(&env->simple),
+                                 REVOKE_WORKER_PRIO);
+    ZF_LOGF_IF(error, "Failed to lower revoke worker priority");
+    if (!config_set(CONFIG_HAVE_TIMER)) {
+        return 0;
+    }
+    uint64_t end = timestamp(env);
+    *revoke_ns = end - env->revoke.requested[pool];
+    return end - start;
+}
+#endif /* CONFIG_SEL4TEST_BACKGROUND_REVOKE */
+
+void revoke_init(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    split_pools(env);
+
+    int error = vka_alloc_notification(&env->vka, &env->revoke.request);
+    ZF_LOGF_IF(error, "Failed to allocate revoke request notification");
+    error = vka_alloc_notification(&env->vka, &env->revoke.done);
+    ZF_LOGF_IF(error, "Failed to allocate revoke done notification");
+    for (int pool = 0; pool < 2; pool++) {
+        env->revoke.request_caps[pool] = mint_badged(env, &env->revoke.request, BIT(pool));
+        env->revoke.done_caps[pool] = mint_badged(env, &env->revoke.done, BIT(pool));
+    }
+
+    /* below every test thread, see REVOKE_WORKER_PRIO */
+    seL4_Word data = api_make_guard_skip_word(seL4_WordBits - simple_get_cnode_size_bits(&env->simple));
+    sel4utils_thread_config_t config = thread_config_default(&env->simple, simple_get_cnode(&env->simple), data,
+                                                             seL4_CapNull, REVOKE_WORKER_PRIO);
+    error = sel4utils_configure_thread_config(&env->vka, &env->vspace, &env->vspace, config, &env->revoke.worker);
+    ZF_LOGF_IF(error, "Failed to configure revoke worker");
+#ifdef CONFIG_DEBUG_BUILD
+    seL4_DebugNameThread(env->revoke.worker.tcb.cptr, "sel4test-revoke");
+#endif
+    error = sel4utils_start_thread(&env->revoke.worker, revoke_worker, env, NULL, 1);
+    ZF_LOGF_IF(error, "Failed to start revoke worker");
+#endif
+}
+
+void revoke_next_untypeds(driver_env_t env, vka_object_t **untypeds, int *num_untypeds)
+{
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    int pool = !env->revoke.current;
+    uint64_t revoke_ns;
+    wait_pool(env, pool, &revoke_ns);
+    env->revoke.current = pool;
+    *untypeds = &env->untypeds[env->revoke.start[pool]];
+    *num_untypeds = env->revoke.num[pool];
+#else
+    *untypeds = env->untypeds;
+    *num_untypeds = env->num_untypeds;
+#endif
+}
+
+void revoke_untypeds(driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    int pool = env->revoke.current;
+    assert(!(env->revoke.pending & BIT(pool)));
+    env->revoke.pending |= BIT(pool);
+    env->revoke.requested[pool] = config_set(CONFIG_HAVE_TIMER) ? timestamp(env) : 0;
+    seL4_Signal(env->revoke.request_caps[pool]);
+#else
+    revoke_pool(env, env->untypeds, env->num_untypeds);
+#endif
+}
+
+void revoke_wait(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    seL4_Word pending = env->revoke.pending;
+    for (int pool = 0; pool < 2; pool++) {
+        if (pending & BIT(pool)) {
+            uint64_t revoke_ns;
+            env->revoke.wait_ns += wait_pool(env, pool, &revoke_ns);
+            env->revoke.revoked_ns += revoke_ns;
+            env->revoke.valid = true;
+        }
+    }
+#endif
+}
+
+void revoke_report_test(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    if (!env->revoke.valid) {
+        return;
+    }
+    env->revoke.valid = false;
+
+    /* The revoke is only timed by the driver, from when it asks for it to when it
+     * sees it done, so revoke_ns is an upper bound. The part that did not overlap
+     * the test is the time waited for it, which is exact. */
+    if (config_set(CONFIG_PRINT_XML)) {
+        printf("\t\t\t<property name=\"revoke_ns\" value=\"%llu\"/>\n",
+               (unsigned long long) env->revoke.revoked_ns);
+        printf("\t\t\t<property name=\"revoke_wait_ns\" value=\"%llu\"/>\n",
+               (unsigned long long) env->revoke.wait_ns);
+    } else {
+        printf("\tBackground revoke: done within %llu us, waited %llu us\n",
+               (unsigned long long) env->revoke.revoked_ns / NS_IN_US,
+               (unsigned long long) env->revoke.wait_ns / NS_IN_US);
+    }
+    env->revoke.revoked_ns = 0;
+    env->revoke.wait_ns = 0;
+#endif
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include "test.h"
+
+/* Revoking the untypeds given to each test process. With
+ * CONFIG_SEL4TEST_BACKGROUND_REVOKE the untypeds are split into two pools that
+ * alternate between tests, and a worker thread at the lowest priority revokes
+ * the pool of the last test while the next one runs.
+ * Otherwise every test gets all the untypeds and they are revoked straight
+ * away. */
+
+/* called once before any tests are run */
+void revoke_init(driver_env_t env);
+/* the untypeds to give to the next test */
+void revoke_next_untypeds(driver_env_t env, vka_object_t **untypeds, int *num_untypeds);
+/* revoke the untypeds of the current test */
+void revoke_untypeds(driver_env_t env);
+/* wait for any revoke still running in the background */
+void revoke_wait(driver_env_t env);
+/* print how long the background revoke of the last test took, and how long it
+ * was waited for, as part of its report */
+void revoke_report_test(driver_env_t env);
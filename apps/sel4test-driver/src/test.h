@@ -24,6 +24,8 @@
 #include <test_init_data.h>
 
 #define TESTS_APP "sel4test-tests"
+/* the tests of TESTS_APP sorted by name, in the archive with it */
+#define TESTS_MANIFEST "sel4test-manifest"
 
 #define MAX_TIMER_IRQS 4
 
@@ -75,17 +77,106 @@ struct driver_env {
     seL4_CPtr init_frame_cap_copy;
 
     void *remote_vaddr;
-    sel4utils_process_t test_process;
+    /* the process of the current test, which is one of test_processes. The
+     * others are used for the prepared and retired processes, see prespawn
+     * and retired below */
+    sel4utils_process_t *test_process;
+    sel4utils_process_t test_processes[3];
+    /* root cnode of the test process' two-level cspace */
+    vka_object_t test_cspace_root;
     seL4_CPtr endpoint;
 
     int num_untypeds;
     vka_object_t *untypeds;
 
+    /* the _test_case section of the tests app, as read from its elf file */
+    testcase_t *test_cases;
+    int num_test_cases;
+
     /* device frame to use for some tests */
     vka_object_t device_obj;
 
     /* time server for managing timeouts */
     time_manager_t tm;
+
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    /* kernel utilisation of the last test, in cycles, see benchmark.c */
+    struct {
+        bool valid;
+        uint64_t thread;
+        uint64_t idle;
+        uint64_t total;
+    } utilisation;
+#endif
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+    /* peak resources used by the last test, see benchmark.c */
+    struct {
+        bool valid;
+        seL4_Word peak_cslots;
+        seL4_Word peak_untyped;
+        seL4_Word peak_objects[seL4_ObjectTypeCount];
+    } resources;
+#endif
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+    /* The process for the next test, prepared while the current test sleeps. The
+     * fields match the ones above, and are swapped with them when the next test
+     * starts. See prespawn_next_test in testtypes.c */
+    struct {
+        /* set by sel4test_run_tests if the next test is also BASIC */
+        bool wanted;
+        /* the process below is set up and waiting for the next test */
+        bool ready;
+        sel4utils_process_t *test_process;
+        test_init_data_t *init;
+        void *remote_vaddr;
+        vka_object_t test_cspace_root;
+        seL4_CPtr endpoint;
+        /* how long the last preparation took */
+        uint64_t set_up_ns;
+    } prespawn;
+#endif
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+    /* the tests elf, in the driver's copy of the archive, see tests_elf.c */
+    elf_t *tests_elf;
+#endif
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    /* state of the background revoke, see revoke.c */
+    struct {
+        /* env->untypeds is split into two pools, pool i is num[i] untypeds from start[i] */
+        int start[2];
+        int num[2];
+        /* pool of the current test */
+        int current;
+        /* bit for each pool the worker has been asked to revoke and has not finished */
+        seL4_Word pending;
+        sel4utils_thread_t worker;
+        /* the worker waits on request and signals done, with the badged caps */
+        vka_object_t request;
+        vka_object_t done;
+        seL4_CPtr request_caps[2];
+        seL4_CPtr done_caps[2];
+        /* when the driver last asked for each pool to be revoked */
+        uint64_t requested[2];
+        /* the revoke finished during the last test, and how much of it was waited for */
+        bool valid;
+        uint64_t revoked_ns;
+        uint64_t wait_ns;
+    } revoke;
+    /* The process of the previous test, which is destroyed once its untypeds have
+     * been revoked, so that none of the objects the driver frees for it are still
+     * referenced from the test's own cnodes. See basic_tear_down in testtypes.c */
+    struct {
+        bool valid;
+        sel4utils_process_t *test_process;
+        void *remote_vaddr;
+        vka_object_t test_cspace_root;
+    } retired;
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    /* buffer the kernel logs each entry to while a test runs, see benchmark.c */
+    void *kernel_log;
+    seL4_CPtr kernel_log_cap;
+#endif
 };
 typedef struct driver_env *driver_env_t;
 
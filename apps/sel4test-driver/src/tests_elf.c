@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+#include <string.h>
+#include <elf/elf.h>
+#include <sel4/sel4.h>
+#include <sel4platsupport/platsupport.h>
+#include <sel4utils/elf.h>
+#include <utils/util.h>
+#include <vka/capops.h>
+#include <vspace/vspace.h>
+
+#include "tests_elf.h"
+
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+/* The frames in bootinfo's userImageFrames back the driver's image, from its
+ * first page onwards */
+extern char __executable_start[];
+
+/* Can the segment of a region be mapped from the driver's image? */
+static bool region_is_shared(elf_t *elf, sel4utils_elf_region_t *region)
+{
+    int seg = region->segment_index;
+    uintptr_t offset = elf_getProgramHeaderOffset(elf, seg);
+    uintptr_t file = (uintptr_t) elf->elfFile;
+
+    return !seL4_CapRights_get_capAllowWrite(region->rights) &&
+           elf_getProgramHeaderFileSize(elf, seg) == elf_getProgramHeaderMemorySize(elf, seg) &&
+           (file + offset) % PAGE_SIZE_4K == elf_getProgramHeaderVaddr(elf, seg) % PAGE_SIZE_4K;
+}
+
+/* the frame backing a page of the driver's image */
+static seL4_CPtr image_frame(uintptr_t vaddr)
+{
+    uintptr_t image_start = ROUND_DOWN((uintptr_t) __executable_start, PAGE_SIZE_4K);
+    return platsupport_get_bootinfo()->userImageFrames.start + (vaddr - image_start) / PAGE_SIZE_4K;
+}
+
+static seL4_CPtr copy_frame(driver_env_t env, seL4_CPtr frame)
+{
+    cspacepath_t src, dest;
+    vka_cspace_make_path(&env->vka, frame, &src);
+    int error = vka_cspace_alloc_path(&env->vka, &dest);
+    ZF_LOGF_IF(error, "Failed to allocate slot for frame");
+    error = vka_cnode_copy(&dest, &src, seL4_AllRights);
+    ZF_LOGF_IF(error, "Failed to copy frame");
+    return dest.capPtr;
+}
+
+static void delete_frame(driver_env_t env, seL4_CPtr frame)
+{
+    cspacepath_t path;
+    vka_cspace_make_path(&env->vka, frame, &path);
+    vka_cnode_delete(&path);
+    vka_cspace_free(&env->vka, frame);
+}
+
+static void map_region(driver_env_t env, elf_t *elf, sel4utils_elf_region_t *region)
+{
+    int seg = region->segment_index;
+    uintptr_t file_page = ROUND_DOWN((uintptr_t) elf->elfFile + elf_getProgramHeaderOffset(elf, seg), PAGE_SIZE_4K);
+
+    for (size_t page = 0; page < ELF_REGION_PAGES(*region); page++) {
+        seL4_CPtr frame = copy_frame(env, image_frame(file_page + page * PAGE_SIZE_4K));
+        void *vaddr = (void *)(ROUND_DOWN(region->elf_vstart, PAGE_SIZE_4K) + page * PAGE_SIZE_4K);
+        int error = vspace_map_pages_at_vaddr(&env->test_process->vspace, &frame, NULL, vaddr, 1, seL4_PageBits,
+                                              region->reservation);
+        ZF_LOGF_IF(error, "Failed to map tests elf frame into test process");
+    }
+}
+
+static void copy_region(driver_env_t env, elf_t *elf, sel4utils_elf_region_t *region)
+{
+    int seg = region->segment_index;
+    uintptr_t seg_vaddr = elf_getProgramHeaderVaddr(elf, seg);
+    size_t filesz = elf_getProgramHeaderFileSize(elf, seg);
+    const char *data = (const char *) elf->elfFile + elf_getProgramHeaderOffset(elf, seg);
+
+    for (size_t page = 0; page < ELF_REGION_PAGES(*region); page++) {
+        uintptr_t vaddr = ROUND_DOWN(region->elf_vstart, PAGE_SIZE_4K) + page * PAGE_SIZE_4K;
+        int error = vspace_new_pages_at_vaddr(&env->test_process->vspace, (void *) vaddr, 1, seL4_PageBits,
+                                              region->reservation);
+        ZF_LOGF_IF(error, "Failed to allocate tests elf frame");
+
+        /* map a copy of the frame to fill it in */
+        seL4_CPtr frame = copy_frame(env, vspace_get_cap(&env->test_process->vspace, (void *) vaddr));
+        char *local = vspace_map_pages(&env->vspace, &frame, NULL, seL4_AllRights, 1, seL4_PageBits, 1);
+        ZF_LOGF_IF(local == NULL, "Failed to map tests elf frame");
+
+        memset(local, 0, PAGE_SIZE_4K);
+        uintptr_t start = MAX(vaddr, seg_vaddr);
+        uintptr_t end = MIN(vaddr + PAGE_SIZE_4K, seg_vaddr + filesz);
+        if (start < end) {
+            memcpy(local + (start - vaddr), data + (start - seg_vaddr), end - start);
+        }
+#ifdef CONFIG_ARCH_ARM
+        seL4_ARM_Page_Unify_Instruction(frame, 0, PAGE_SIZE_4K);
+#endif
+
+        vspace_unmap_pages(&env->vspace, local, 1, seL4_PageBits, NULL);
+        delete_frame(env, frame);
+    }
+}
+#endif /* CONFIG_SEL4TEST_ZERO_COPY_ELF */
+
+void tests_elf_load(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+    sel4utils_process_t *process = env->test_process;
+
+    for (int i = 0; i < process->num_elf_regions; i++) {
+        sel4utils_elf_region_t *region = &process->elf_regions[i];
+        if (region_is_shared(env->tests_elf, region)) {
+            map_region(env, env->tests_elf, region);
+        } else {
+            copy_region(env, env->tests_elf, region);
+        }
+    }
+#endif
+}
+
+void tests_elf_unload(UNUSED driver_env_t env)
+{
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+    sel4utils_process_t *process = env->test_process;
+
+    /* the frames of the shared regions are only copies of the driver's caps, the
+     * frames themselves must not be freed with the process */
+    for (int i = 0; i < process->num_elf_regions; i++) {
+        sel4utils_elf_region_t *region = &process->elf_regions[i];
+        if (!region_is_shared(env->tests_elf, region)) {
+            continue;
+        }
+        for (size_t page = 0; page < ELF_REGION_PAGES(*region); page++) {
+            void *vaddr = (void *)(ROUND_DOWN(region->elf_vstart, PAGE_SIZE_4K) + page * PAGE_SIZE_4K);
+            seL4_CPtr frame = vspace_get_cap(&process->vspace, vaddr);
+            vspace_unmap_pages(&process->vspace, vaddr, 1, seL4_PageBits, NULL);
+            delete_frame(env, frame);
+        }
+    }
+#endif
+}
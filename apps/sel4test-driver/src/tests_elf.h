@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include "test.h"
+
+/* Loading the tests ELF into a test process without copying it
+ * (enabled by CONFIG_SEL4TEST_ZERO_COPY_ELF).
+ *
+ * The CPIO archive is built so that the tests ELF starts on a page boundary
+ * in the driver's image. Read only segments that are all file contents are then
+ * mapped into the test process straight from the frames that back the driver's
+ * image. Other segments are copied into new frames, as sel4utils would. */
+
+/* load env->tests_elf into the test process, which was configured without loading it */
+void tests_elf_load(driver_env_t env);
+/* unmap the frames tests_elf_load did not allocate, before the test process is destroyed */
+void tests_elf_unload(driver_env_t env);
@@ -13,6 +13,9 @@
 
 #include "test.h"
 #include "timer.h"
+#include "benchmark.h"
+#include "revoke.h"
+#include "tests_elf.h"
 #include <sel4rpc/server.h>
 #include <sel4testsupport/testreporter.h>
 
@@ -43,23 +46,90 @@ static DEFINE_TEST_TYPE(BOOTSTRAP, BOOTSTRAP,
                         bootstrap_set_up, bootstrap_tear_down, bootstrap_run_test);
 
 /* Basic test type. Each test is launched as its own process. */
-/* copy untyped caps into a processes cspace, return the cap range they can be found in */
-static seL4_SlotRegion copy_untypeds_to_process(sel4utils_process_t *process, vka_object_t *untypeds, int num_untypeds,
-                                                driver_env_t env)
+/* Copy the untyped caps into the slots set_up_test_process reserved for them. This
+ * is only done once the previous test's untypeds have been revoked, so that a
+ * process prepared in advance never shares memory with the test still running. */
+static void copy_untypeds_to_process(driver_env_t env)
 {
-    seL4_SlotRegion range = {0};
+    vka_object_t *untypeds;
+    int num_untypeds;
 
+    revoke_next_untypeds(env, &untypeds, &num_untypeds);
     for (int i = 0; i < num_untypeds; i++) {
-        seL4_CPtr slot = sel4utils_copy_cap_to_process(process, &env->vka, untypeds[i].cptr);
+        cspacepath_t src;
+        cspacepath_t dest = {
+            .root = env->test_process->cspace.cptr,
+            .capPtr = env->init->untypeds.start + i,
+            .capDepth = env->test_process->cspace_size
+        };
+        vka_cspace_make_path(&env->vka, untypeds[i].cptr, &src);
+        int error = vka_cnode_copy(&dest, &src, seL4_AllRights);
+        ZF_LOGF_IF(error, "Failed to copy untyped to test process");
+        env->init->untyped_size_bits_list[i] = untypeds[i].size_bits;
+    }
+    env->init->untypeds.end = env->init->untypeds.start + num_untypeds - 1;
+}
+
+#ifdef CONFIG_SEL4TEST_SHARE_HELPER_TEXT
+/* Copy the frames of the read only elf regions into the test process, so that it
+ * can map them into its helper processes instead of copying them */
+static void copy_elf_frames_to_process(driver_env_t env)
+{
+    for (int i = 0; i < env->init->num_elf_regions; i++) {
+        sel4utils_elf_region_t *region = &env->init->elf_regions[i];
+
+        env->init->elf_region_frames[i] = seL4_CapNull;
+        if (seL4_CapRights_get_capAllowWrite(region->rights)) {
+            continue;
+        }
 
-        /* set up the cap range */
-        if (i == 0) {
-            range.start = slot;
+        uintptr_t vaddr = ROUND_DOWN(region->elf_vstart, PAGE_SIZE_4K);
+        for (size_t page = 0; page < ELF_REGION_PAGES(*region); page++) {
+            seL4_CPtr frame = vspace_get_cap(&env->test_process->vspace, (void *)(vaddr + page * PAGE_SIZE_4K));
+            assert(frame != seL4_CapNull);
+            seL4_CPtr slot = sel4utils_copy_cap_to_process(env->test_process, &env->vka, frame);
+            if (page == 0) {
+                env->init->elf_region_frames[i] = slot;
+            }
+            assert(slot == env->init->elf_region_frames[i] + page);
         }
-        range.end = slot;
     }
-    assert((range.end - range.start) + 1 == num_untypeds);
-    return range;
+}
+#endif /* CONFIG_SEL4TEST_SHARE_HELPER_TEXT */
+
+/* Give the test process a two-level cspace. The cnode sel4utils created for
+ * the process becomes the first level two cnode, so the caps already copied
+ * into it keep their cptrs. Returns the slot of the new root in the process. */
+static seL4_CPtr create_two_level_cspace(driver_env_t env)
+{
+    int error;
+    cspacepath_t src;
+    seL4_Word guard = api_make_guard_skip_word(seL4_WordBits - TEST_PROCESS_CSPACE_SIZE_BITS);
+#ifdef CONFIG_KERNEL_MCS
+    /* on the MCS kernel the fault endpoint is looked up in our cspace */
+    seL4_CPtr fault_ep = env->test_process->fault_endpoint.cptr;
+#else
+    seL4_CPtr fault_ep = SEL4UTILS_ENDPOINT_SLOT;
+#endif
+
+    error = vka_alloc_cnode_object(&env->vka, TEST_PROCESS_CSPACE_L1_BITS, &env->test_cspace_root);
+    ZF_LOGF_IF(error, "Failed to allocate root cnode for test process");
+
+    cspacepath_t level_two = {
+        .root = env->test_cspace_root.cptr,
+        .capPtr = 0,
+        .capDepth = TEST_PROCESS_CSPACE_L1_BITS
+    };
+    vka_cspace_make_path(&env->vka, env->test_process->cspace.cptr, &src);
+    error = vka_cnode_copy(&level_two, &src, seL4_AllRights);
+    ZF_LOGF_IF(error, "Failed to copy level two cnode into root cnode");
+
+    error = api_tcb_set_space(env->test_process->thread.tcb.cptr, fault_ep, env->test_cspace_root.cptr, guard,
+                              env->test_process->pd.cptr, seL4_NilData);
+    ZF_LOGF_IF(error, "Failed to set test process cspace");
+
+    vka_cspace_make_path(&env->vka, env->test_cspace_root.cptr, &src);
+    return sel4utils_mint_cap_to_process(env->test_process, src, seL4_AllRights, guard);
 }
 
 static void handle_timer_requests(driver_env_t env, sel4test_output_t test_output)
@@ -106,6 +176,16 @@ static void handle_timer_requests(driver_env_t env, sel4test_output_t test_outpu
 
 }
 
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+/* only prepare the next test during a sleep at least this many times longer
+ * than the last preparation took */
+#define PRESPAWN_SLEEP_FACTOR 2
+/* and never during a sleep shorter than this */
+#define PRESPAWN_MIN_SLEEP_NS (10 * NS_IN_MS)
+
+static void prespawn_next_test(driver_env_t env, uint64_t sleep_ns);
+#endif
+
 /* This function waits on:
  * Timer interrupts (from hardware)
  * Requests from tests (sel4driver acts as a server)
@@ -124,7 +204,7 @@ static int sel4test_driver_wait(driver_env_t env, struct testcase *test)
 
     while (1) {
         /* wait for tests to finish or fault, receive test request or report result */
-        info = api_recv(env->test_process.fault_endpoint.cptr, &badge, env->reply.cptr);
+        info = api_recv(env->test_process->fault_endpoint.cptr, &badge, env->reply.cptr);
         test_output = seL4_GetMR(0);
 
         /* FIXME: Assumptions made at the time of writing this code:
@@ -155,7 +235,17 @@ static int sel4test_driver_wait(driver_env_t env, struct testcase *test)
         if (sel4test_isTimerRPC(test_output)) {
 
             if (config_set(CONFIG_HAVE_TIMER)) {
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+                bool sleeping = test_output == SEL4TEST_TIME_TIMEOUT && seL4_GetMR(1) == TIMEOUT_RELATIVE;
+                uint64_t sleep_ns = sleeping ? sel4utils_64_get_mr(2) : 0;
+#endif
                 handle_timer_requests(env, test_output);
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+                /* the test has been replied to and is waiting for the timeout */
+                if (sleeping) {
+                    prespawn_next_test(env, sleep_ns);
+                }
+#endif
                 continue;
             } else {
                 ZF_LOGF("Requesting a timer service from sel4test-driver while there is no"
@@ -170,8 +260,10 @@ static int sel4test_driver_wait(driver_env_t env, struct testcase *test)
         if (seL4_MessageInfo_get_label(info) != seL4_Fault_NullFault) {
             sel4utils_print_fault_message(info, test->name);
             printf("Register of root thread in test (may not be the thread that faulted)\n");
-            sel4debug_dump_registers(env->test_process.thread.tcb.cptr);
+            sel4debug_dump_registers(env->test_process->thread.tcb.cptr);
             result = FAILURE;
+        } else {
+            benchmark_read_result(env, info);
         }
 
         if (config_set(CONFIG_HAVE_TIMER)) {
@@ -182,64 +274,78 @@ static int sel4test_driver_wait(driver_env_t env, struct testcase *test)
     }
 }
 
-void basic_set_up(uintptr_t e)
+/* Create the test process, and fill in everything in env->init that does not
+ * depend on the test being run. Returns false if the process could not be
+ * configured. */
+static bool set_up_test_process(driver_env_t env)
 {
     int error;
-    driver_env_t env = (driver_env_t)e;
 
     sel4utils_process_config_t config = process_config_default_simple(&env->simple, TESTS_APP, env->init->priority);
     config = process_config_mcp(config, seL4_MaxPrio);
     config = process_config_auth(config, simple_get_tcb(&env->simple));
-    config = process_config_create_cnode(config, TEST_PROCESS_CSPACE_SIZE_BITS);
-    error = sel4utils_configure_process_custom(&(env->test_process), &env->vka, &env->vspace, config);
-    assert(error == 0);
+    config = process_config_create_cnode(config, TEST_PROCESS_CSPACE_L2_BITS);
+#ifdef CONFIG_SEL4TEST_ZERO_COPY_ELF
+    /* only reserve the elf regions, tests_elf_load maps them in */
+    config.do_elf_load = false;
+#endif
+    error = sel4utils_configure_process_custom(env->test_process, &env->vka, &env->vspace, config);
+    if (error) {
+        ZF_LOGE("Failed to configure test process");
+        return false;
+    }
+    tests_elf_load(env);
 
     /* set up caps about the process */
     env->init->stack_pages = CONFIG_SEL4UTILS_STACK_SIZE / PAGE_SIZE_4K;
-    env->init->stack = env->test_process.thread.stack_top - CONFIG_SEL4UTILS_STACK_SIZE;
-    env->init->page_directory = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, env->test_process.pd.cptr);
-    env->init->root_cnode = SEL4UTILS_CNODE_SLOT;
-    env->init->tcb = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, env->test_process.thread.tcb.cptr);
+    env->init->stack = env->test_process->thread.stack_top - CONFIG_SEL4UTILS_STACK_SIZE;
+    env->init->page_directory = sel4utils_copy_cap_to_process(env->test_process, &env->vka, env->test_process->pd.cptr);
+    env->init->tcb = sel4utils_copy_cap_to_process(env->test_process, &env->vka, env->test_process->thread.tcb.cptr);
     if (config_set(CONFIG_HAVE_TIMER)) {
-        env->init->timer_ntfn = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, env->timer_notify_test.cptr);
+        env->init->timer_ntfn = sel4utils_copy_cap_to_process(env->test_process, &env->vka, env->timer_notify_test.cptr);
     }
 
-    env->init->domain = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, simple_get_init_cap(&env->simple,
+    env->init->domain = sel4utils_copy_cap_to_process(env->test_process, &env->vka, simple_get_init_cap(&env->simple,
                                                                                                            seL4_CapDomain));
-    env->init->asid_pool = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, simple_get_init_cap(&env->simple,
+    env->init->asid_pool = sel4utils_copy_cap_to_process(env->test_process, &env->vka, simple_get_init_cap(&env->simple,
                                                                                                               seL4_CapInitThreadASIDPool));
-    env->init->asid_ctrl = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, simple_get_init_cap(&env->simple,
+    env->init->asid_ctrl = sel4utils_copy_cap_to_process(env->test_process, &env->vka, simple_get_init_cap(&env->simple,
                                                                                                               seL4_CapASIDControl));
 #ifdef CONFIG_IOMMU
-    env->init->io_space = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, simple_get_init_cap(&env->simple,
+    env->init->io_space = sel4utils_copy_cap_to_process(env->test_process, &env->vka, simple_get_init_cap(&env->simple,
                                                                                                              seL4_CapIOSpace));
 #endif /* CONFIG_IOMMU */
 #ifdef CONFIG_TK1_SMMU
-    env->init->io_space_caps = arch_copy_iospace_caps_to_process(&(env->test_process), &env);
+    env->init->io_space_caps = arch_copy_iospace_caps_to_process(env->test_process, &env);
 #endif
     env->init->cores = simple_get_core_count(&env->simple);
     /* copy the sched ctrl caps to the remote process */
     if (config_set(CONFIG_KERNEL_MCS)) {
         seL4_CPtr sched_ctrl = simple_get_sched_ctrl(&env->simple, 0);
-        env->init->sched_ctrl = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, sched_ctrl);
+        env->init->sched_ctrl = sel4utils_copy_cap_to_process(env->test_process, &env->vka, sched_ctrl);
         for (int i = 1; i < env->init->cores; i++) {
             sched_ctrl = simple_get_sched_ctrl(&env->simple, i);
-            sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, sched_ctrl);
+            sel4utils_copy_cap_to_process(env->test_process, &env->vka, sched_ctrl);
         }
     }
-    /* setup data about untypeds */
-    env->init->untypeds = copy_untypeds_to_process(&(env->test_process), env->untypeds, env->num_untypeds, env);
+    /* reserve slots for the untypeds, see copy_untypeds_to_process */
+    env->init->untypeds.start = env->test_process->cspace_next_free;
+    env->test_process->cspace_next_free += env->num_untypeds;
+    env->init->root_cnode = create_two_level_cspace(env);
+#ifdef CONFIG_SEL4TEST_SHARE_HELPER_TEXT
+    copy_elf_frames_to_process(env);
+#endif
     /* copy the fault endpoint - we wait on the endpoint for a message
      * or a fault to see when the test finishes */
-    env->endpoint = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, env->test_process.fault_endpoint.cptr);
+    env->endpoint = sel4utils_copy_cap_to_process(env->test_process, &env->vka, env->test_process->fault_endpoint.cptr);
 
     /* copy the device frame, if any */
     if (env->init->device_frame_cap) {
-        env->init->device_frame_cap = sel4utils_copy_cap_to_process(&(env->test_process), &env->vka, env->device_obj.cptr);
+        env->init->device_frame_cap = sel4utils_copy_cap_to_process(env->test_process, &env->vka, env->device_obj.cptr);
     }
 
     /* map the cap into remote vspace */
-    env->remote_vaddr = vspace_share_mem(&env->vspace, &(env->test_process).vspace, env->init, 1, PAGE_BITS_4K,
+    env->remote_vaddr = vspace_share_mem(&env->vspace, &env->test_process->vspace, env->init, 1, PAGE_BITS_4K,
                                          seL4_AllRights, 1);
     assert(env->remote_vaddr != 0);
 
@@ -252,8 +358,166 @@ void basic_set_up(uintptr_t e)
     } else {
         env->init->free_slots.start = env->endpoint + 1;
     }
-    env->init->free_slots.end = (1u << TEST_PROCESS_CSPACE_SIZE_BITS);
+    env->init->free_slots.end = (1u << TEST_PROCESS_CSPACE_L2_BITS);
     assert(env->init->free_slots.start < env->init->free_slots.end);
+    return true;
+}
+
+/* Destroy a test process that has been set up, without touching the untypeds */
+static void destroy_test_process(driver_env_t env)
+{
+    /* unmap the env->init data frame */
+    vspace_unmap_pages(&env->test_process->vspace, env->remote_vaddr, 1, PAGE_BITS_4K, NULL);
+
+    /* the first level two cnode holds a cap to the root cnode, so break the
+     * cycle before destroying them. Level two cnodes created by the test were
+     * removed by revoking the untypeds. */
+    cspacepath_t level_two = {
+        .root = env->test_cspace_root.cptr,
+        .capPtr = 0,
+        .capDepth = TEST_PROCESS_CSPACE_L1_BITS
+    };
+    vka_cnode_delete(&level_two);
+
+    /* destroy the process */
+    tests_elf_unload(env);
+    sel4utils_destroy_process(env->test_process, &env->vka);
+    vka_free_object(&env->vka, &env->test_cspace_root);
+}
+
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+/* exchange the current test process with the prepared one */
+static void prespawn_swap(driver_env_t env)
+{
+    sel4utils_process_t *test_process = env->test_process;
+    test_init_data_t *init = env->init;
+    void *remote_vaddr = env->remote_vaddr;
+    vka_object_t test_cspace_root = env->test_cspace_root;
+    seL4_CPtr endpoint = env->endpoint;
+
+    env->test_process = env->prespawn.test_process;
+    env->init = env->prespawn.init;
+    env->remote_vaddr = env->prespawn.remote_vaddr;
+    env->test_cspace_root = env->prespawn.test_cspace_root;
+    env->endpoint = env->prespawn.endpoint;
+
+    env->prespawn.test_process = test_process;
+    env->prespawn.init = init;
+    env->prespawn.remote_vaddr = remote_vaddr;
+    env->prespawn.test_cspace_root = test_cspace_root;
+    env->prespawn.endpoint = endpoint;
+}
+
+/* Set up the process for the next test while the current test sleeps. This
+ * is only worth doing, and only safe for the timing of the current test, if
+ * the sleep is comfortably longer than the set up takes. */
+static void prespawn_next_test(driver_env_t env, uint64_t sleep_ns)
+{
+    if (!env->prespawn.wanted || env->prespawn.ready ||
+        sleep_ns < MAX(PRESPAWN_MIN_SLEEP_NS, env->prespawn.set_up_ns * PRESPAWN_SLEEP_FACTOR)) {
+        return;
+    }
+
+    uint64_t start = timestamp(env);
+    prespawn_swap(env);
+    /* the static parts of the init data are only filled in once, in main */
+    memcpy(env->init, env->prespawn.init, sizeof(test_init_data_t));
+    bool ready = set_up_test_process(env);
+    prespawn_swap(env);
+    env->prespawn.ready = ready;
+    env->prespawn.set_up_ns = timestamp(env) - start;
+}
+
+static void prespawn_discard(driver_env_t env)
+{
+    if (env->prespawn.ready) {
+        prespawn_swap(env);
+        destroy_test_process(env);
+        prespawn_swap(env);
+        env->prespawn.ready = false;
+    }
+}
+
+#endif /* CONFIG_SEL4TEST_PRESPAWN */
+
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+/* destroy the process of the previous test, once its untypeds are revoked */
+static void retired_destroy(driver_env_t env)
+{
+    revoke_wait(env);
+    if (!env->retired.valid) {
+        return;
+    }
+
+    sel4utils_process_t *test_process = env->test_process;
+    void *remote_vaddr = env->remote_vaddr;
+    vka_object_t test_cspace_root = env->test_cspace_root;
+
+    env->test_process = env->retired.test_process;
+    env->remote_vaddr = env->retired.remote_vaddr;
+    env->test_cspace_root = env->retired.test_cspace_root;
+    destroy_test_process(env);
+    env->retired.valid = false;
+
+    env->test_process = test_process;
+    env->remote_vaddr = remote_vaddr;
+    env->test_cspace_root = test_cspace_root;
+}
+
+/* stop the current test process and keep it to be destroyed by retired_destroy */
+static void retire_test_process(driver_env_t env)
+{
+    assert(!env->retired.valid);
+    int error = seL4_TCB_Suspend(env->test_process->thread.tcb.cptr);
+    ZF_LOGF_IF(error, "Failed to suspend test process");
+
+    env->retired.valid = true;
+    env->retired.test_process = env->test_process;
+    env->retired.remote_vaddr = env->remote_vaddr;
+    env->retired.test_cspace_root = env->test_cspace_root;
+
+    /* the next test needs a process that is neither retired nor prepared */
+    for (int i = 0; i < ARRAY_SIZE(env->test_processes); i++) {
+        sel4utils_process_t *test_process = &env->test_processes[i];
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+        if (test_process == env->prespawn.test_process) {
+            continue;
+        }
+#endif
+        if (test_process != env->retired.test_process) {
+            env->test_process = test_process;
+            break;
+        }
+    }
+}
+#endif /* CONFIG_SEL4TEST_BACKGROUND_REVOKE */
+
+static void basic_tear_down_test_type(uintptr_t e)
+{
+    UNUSED driver_env_t env = (driver_env_t)e;
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+    prespawn_discard(env);
+#endif
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    retired_destroy(env);
+#endif
+}
+
+void basic_set_up(uintptr_t e)
+{
+    driver_env_t env = (driver_env_t)e;
+
+#ifdef CONFIG_SEL4TEST_PRESPAWN
+    if (env->prespawn.ready) {
+        prespawn_swap(env);
+        env->prespawn.ready = false;
+    } else
+#endif
+    {
+        bool ok = set_up_test_process(env);
+        ZF_LOGF_IF(!ok, "Failed to set up test process");
+    }
+    copy_untypeds_to_process(env);
 }
 
 test_result_t basic_run_test(struct testcase *test, uintptr_t e)
@@ -261,12 +525,12 @@ test_result_t basic_run_test(struct testcase *test, uintptr_t e)
     int error;
     driver_env_t env = (driver_env_t)e;
 
-    /* copy test name */
-    strncpy(env->init->name, test->name, TEST_NAME_MAX);
-    /* ensure string is null terminated */
-    env->init->name[TEST_NAME_MAX - 1] = '\0';
+    /* the test process finds its test by its index in its _test_case section */
+    ZF_LOGF_IF(test < env->test_cases || test >= env->test_cases + env->num_test_cases,
+               "Test %s is not in "TESTS_APP, test->name);
+    env->init->test_index = test - env->test_cases;
 #ifdef CONFIG_DEBUG_BUILD
-    seL4_DebugNameThread(env->test_process.thread.tcb.cptr, env->init->name);
+    seL4_DebugNameThread(env->test_process->thread.tcb.cptr, test->name);
 #endif
 
     /* set up args for the test process */
@@ -275,8 +539,10 @@ test_result_t basic_run_test(struct testcase *test, uintptr_t e)
     char *argv[argc];
     sel4utils_create_word_args(string_args, argv, argc, env->endpoint, env->remote_vaddr);
 
+    benchmark_start_test(env);
+
     /* spawn the process */
-    error = sel4utils_spawn_process_v(&(env->test_process), &env->vka, &env->vspace,
+    error = sel4utils_spawn_process_v(env->test_process, &env->vka, &env->vspace,
                                       argc, argv, 1);
     ZF_LOGF_IF(error != 0, "Failed to start test process!");
 
@@ -287,6 +553,7 @@ test_result_t basic_run_test(struct testcase *test, uintptr_t e)
 
     /* wait on it to finish or fault, report result */
     int result = sel4test_driver_wait(env, test);
+    benchmark_end_test(env);
 
     test_assert(result == SUCCESS);
 
@@ -296,19 +563,19 @@ test_result_t basic_run_test(struct testcase *test, uintptr_t e)
 void basic_tear_down(uintptr_t e)
 {
     driver_env_t env = (driver_env_t)e;
-    /* unmap the env->init data frame */
-    vspace_unmap_pages(&(env->test_process).vspace, env->remote_vaddr, 1, PAGE_BITS_4K, NULL);
 
+#ifdef CONFIG_SEL4TEST_BACKGROUND_REVOKE
+    /* The untypeds are revoked while the next test runs, and the process is only
+     * destroyed after that, at the end of the next test. */
+    retired_destroy(env);
+    revoke_untypeds(env);
+    retire_test_process(env);
+#else
     /* reset all the untypeds for the next test */
-    for (int i = 0; i < env->num_untypeds; i++) {
-        cspacepath_t path;
-        vka_cspace_make_path(&env->vka, env->untypeds[i].cptr, &path);
-        vka_cnode_revoke(&path);
-    }
-
-    /* destroy the process */
-    sel4utils_destroy_process(&(env->test_process), &env->vka);
+    revoke_untypeds(env);
+    destroy_test_process(env);
+#endif
 }
 
-DEFINE_TEST_TYPE(BASIC, BASIC, NULL, NULL, basic_set_up, basic_tear_down, basic_run_test);
+DEFINE_TEST_TYPE(BASIC, BASIC, NULL, basic_tear_down_test_type, basic_set_up, basic_tear_down, basic_run_test);
 
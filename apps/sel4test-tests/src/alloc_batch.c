@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+
+#include <assert.h>
+
+#include <sel4/sel4.h>
+#include <utils/util.h>
+#include <vka/kobject_t.h>
+#include <vka/object.h>
+
+#include "alloc_batch.h"
+
+#ifdef CONFIG_SEL4TEST_BATCH_ALLOC
+
+/* total number of batches, across all types */
+#define ALLOC_BATCH_MAX 64
+/* number of object types that are batched */
+#define ALLOC_BATCH_TYPES 6
+
+typedef struct alloc_batch {
+    /* type and size of the objects in this batch, batch is unused if size_bits is 0 */
+    seL4_Word type;
+    seL4_Word size_bits;
+    /* the untyped the objects are retyped from */
+    vka_object_t untyped;
+    /* the CNode the objects are retyped into */
+    vka_object_t cnode;
+    /* the next slot of cnode to hand out, ALLOC_BATCH_SIZE if it is empty */
+    int next;
+    /* Nonzero for each object that has been handed out and not freed. The
+     * address of each element is used as the cookie for that object. */
+    uint8_t live[ALLOC_BATCH_SIZE];
+} alloc_batch_t;
+
+static struct {
+    /* the vka functions being wrapped */
+    vka_t base;
+    alloc_batch_t batches[ALLOC_BATCH_MAX];
+    /* the batch each type is currently allocating from, by index into types */
+    alloc_batch_t *current[ALLOC_BATCH_TYPES];
+    struct {
+        seL4_Word type;
+        seL4_Word size_bits;
+    } types[ALLOC_BATCH_TYPES];
+    int num_types;
+} alloc_batch;
+
+static int batch_type_index(seL4_Word type, seL4_Word size_bits)
+{
+    for (int i = 0; i < alloc_batch.num_types; i++) {
+        if (alloc_batch.types[i].type == type && alloc_batch.types[i].size_bits == size_bits) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int batch_live(alloc_batch_t *batch)
+{
+    int live = 0;
+    for (int i = 0; i < ALLOC_BATCH_SIZE; i++) {
+        live += batch->live[i];
+    }
+    return live;
+}
+
+/* retype a whole batch of objects into the batch's cnode */
+static int batch_retype(alloc_batch_t *batch)
+{
+    cspacepath_t path;
+    vka_cspace_make_path(&alloc_batch.base, batch->cnode.cptr, &path);
+    int error = seL4_Untyped_Retype(batch->untyped.cptr, batch->type, batch->size_bits, path.root, path.capPtr,
+                                    path.capDepth, 0, ALLOC_BATCH_SIZE);
+    if (error == seL4_NoError) {
+        batch->next = 0;
+    }
+    return error;
+}
+
+/* Find a batch with objects left of the given type, filling one if needed.
+ * A used up batch can be filled again once all of its objects have been freed, as
+ * the kernel resets an untyped that has no children. */
+static alloc_batch_t *batch_get(int index)
+{
+    alloc_batch_t *batch = alloc_batch.current[index];
+    seL4_Word type = alloc_batch.types[index].type;
+    seL4_Word size_bits = alloc_batch.types[index].size_bits;
+
+    if (batch != NULL && batch->next < ALLOC_BATCH_SIZE) {
+        return batch;
+    }
+
+    for (int i = 0; i < ALLOC_BATCH_MAX; i++) {
+        batch = &alloc_batch.batches[i];
+        if (batch->size_bits == 0) {
+            /* never used, allocate its untyped and cnode */
+            size_t untyped_bits = vka_get_object_size(type, size_bits) + ALLOC_BATCH_BITS;
+            if (vka_alloc_untyped(&alloc_batch.base, untyped_bits, &batch->untyped)) {
+                return NULL;
+            }
+            if (vka_alloc_cnode_object(&alloc_batch.base, ALLOC_BATCH_BITS, &batch->cnode)) {
+                vka_free_object(&alloc_batch.base, &batch->untyped);
+                return NULL;
+            }
+            batch->type = type;
+            batch->size_bits = size_bits;
+        } else if (batch->type != type || batch->size_bits != size_bits ||
+                   batch->next < ALLOC_BATCH_SIZE || batch_live(batch) != 0) {
+            continue;
+        }
+
+        if (batch_retype(batch) == seL4_NoError) {
+            alloc_batch.current[index] = batch;
+            return batch;
+        }
+    }
+
+    return NULL;
+}
+
+static alloc_batch_t *batch_from_cookie(seL4_Word cookie, int *object)
+{
+    seL4_Word start = (seL4_Word) &alloc_batch.batches[0];
+    seL4_Word end = (seL4_Word) &alloc_batch.batches[ALLOC_BATCH_MAX];
+
+    if (cookie < start || cookie >= end) {
+        return NULL;
+    }
+    alloc_batch_t *batch = &alloc_batch.batches[(cookie - start) / sizeof(alloc_batch_t)];
+    *object = (uint8_t *) cookie - batch->live;
+    assert(*object >= 0 && *object < ALLOC_BATCH_SIZE);
+    return batch;
+}
+
+/* Move the next object of a batch into dest. Returns -1 if the object is not
+ * batched, or no batch could be filled. */
+static int batch_alloc(const cspacepath_t *dest, seL4_Word type, seL4_Word size_bits, seL4_Word *res)
+{
+    int index = batch_type_index(type, size_bits);
+    if (index == -1) {
+        return -1;
+    }
+
+    alloc_batch_t *batch = batch_get(index);
+    if (batch == NULL) {
+        return -1;
+    }
+
+    int object = batch->next;
+    int error = seL4_CNode_Move(dest->root, dest->capPtr, dest->capDepth,
+                                batch->cnode.cptr, object, ALLOC_BATCH_BITS);
+    if (error != seL4_NoError) {
+        ZF_LOGE("Failed to move batched object");
+        return error;
+    }
+
+    batch->next++;
+    batch->live[object] = 1;
+    *res = (seL4_Word) &batch->live[object];
+    return 0;
+}
+
+static int alloc_batch_utspace_alloc(void *data, const cspacepath_t *dest, seL4_Word type, seL4_Word size_bits,
+                                     seL4_Word *res)
+{
+    int error = batch_alloc(dest, type, size_bits, res);
+    if (error == -1) {
+        error = alloc_batch.base.utspace_alloc(data, dest, type, size_bits, res);
+    }
+    return error;
+}
+
+static int alloc_batch_utspace_alloc_maybe_device(void *data, const cspacepath_t *dest, seL4_Word type,
+                                                  seL4_Word size_bits, bool can_use_dev, seL4_Word *res)
+{
+    int error = -1;
+    if (!can_use_dev) {
+        error = batch_alloc(dest, type, size_bits, res);
+    }
+    if (error == -1) {
+        error = alloc_batch.base.utspace_alloc_maybe_device(data, dest, type, size_bits, can_use_dev, res);
+    }
+    return error;
+}
+
+static void alloc_batch_utspace_free(void *data, seL4_Word type, seL4_Word size_bits, seL4_Word target)
+{
+    int object;
+    alloc_batch_t *batch = batch_from_cookie(target, &object);
+    if (batch == NULL) {
+        alloc_batch.base.utspace_free(data, type, size_bits, target);
+        return;
+    }
+    /* the memory is reused once the rest of the batch has been freed */
+    batch->live[object] = 0;
+}
+
+static uintptr_t alloc_batch_utspace_paddr(void *data, seL4_Word target, seL4_Word type, seL4_Word size_bits)
+{
+    int object;
+    alloc_batch_t *batch = batch_from_cookie(target, &object);
+    if (batch == NULL) {
+        return alloc_batch.base.utspace_paddr(data, target, type, size_bits);
+    }
+    uintptr_t paddr = alloc_batch.base.utspace_paddr(data, batch->untyped.ut, seL4_UntypedObject,
+                                                     batch->untyped.size_bits);
+    if (paddr == VKA_NO_PADDR) {
+        return paddr;
+    }
+    return paddr + (object << vka_get_object_size(type, size_bits));
+}
+
+static void add_batch_type(seL4_Word type, seL4_Word size_bits)
+{
+    assert(alloc_batch.num_types < ARRAY_SIZE(alloc_batch.types));
+    alloc_batch.types[alloc_batch.num_types].type = type;
+    alloc_batch.types[alloc_batch.num_types].size_bits = size_bits;
+    alloc_batch.num_types++;
+}
+#endif /* CONFIG_SEL4TEST_BATCH_ALLOC */
+
+void alloc_batch_wrap_vka(UNUSED vka_t *vka)
+{
+#ifdef CONFIG_SEL4TEST_BATCH_ALLOC
+    add_batch_type(kobject_get_type(KOBJECT_FRAME, seL4_PageBits), seL4_PageBits);
+    add_batch_type(seL4_TCBObject, seL4_TCBBits);
+    add_batch_type(seL4_EndpointObject, seL4_EndpointBits);
+    add_batch_type(seL4_NotificationObject, seL4_NotificationBits);
+#ifdef CONFIG_KERNEL_MCS
+    add_batch_type(seL4_ReplyObject, seL4_ReplyBits);
+    add_batch_type(seL4_SchedContextObject, seL4_MinSchedContextBits);
+#endif
+
+    alloc_batch.base = *vka;
+    vka->utspace_alloc = alloc_batch_utspace_alloc;
+    vka->utspace_alloc_maybe_device = alloc_batch_utspace_alloc_maybe_device;
+    vka->utspace_free = alloc_batch_utspace_free;
+    vka->utspace_paddr = alloc_batch_utspace_paddr;
+#endif
+}
+
+void alloc_batch_unwrap_vka(vka_t *vka, vka_t *unwrapped)
+{
+    *unwrapped = *vka;
+#ifdef CONFIG_SEL4TEST_BATCH_ALLOC
+    unwrapped->utspace_alloc = alloc_batch.base.utspace_alloc;
+    unwrapped->utspace_alloc_maybe_device = alloc_batch.base.utspace_alloc_maybe_device;
+    unwrapped->utspace_free = alloc_batch.base.utspace_free;
+    unwrapped->utspace_paddr = alloc_batch.base.utspace_paddr;
+#endif
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <vka/vka.h>
+
+/* Batched object allocation (enabled by CONFIG_SEL4TEST_BATCH_ALLOC).
+ *
+ * Frames, TCBs, endpoints, notifications and, with CONFIG_KERNEL_MCS, replies and
+ * scheduling contexts are retyped ALLOC_BATCH_SIZE at a time, with a single
+ * seL4_Untyped_Retype, into the consecutive slots of a small CNode. Allocations
+ * of these objects through the vka are then served from the batch by moving a
+ * cap into the slot the caller asked for. Once every object of a batch has been
+ * freed the same untyped is retyped again for the next batch.
+ *
+ * Anything else, device memory, and allocations made when no batch can be
+ * filled, go straight to the wrapped vka. */
+
+#define ALLOC_BATCH_BITS 4
+#define ALLOC_BATCH_SIZE BIT(ALLOC_BATCH_BITS)
+
+/* Wrap the utspace functions of a vka to allocate objects in batches. Does
+ * nothing unless CONFIG_SEL4TEST_BATCH_ALLOC is set. */
+void alloc_batch_wrap_vka(vka_t *vka);
+
+/* Fill unwrapped with the vka that vka, as wrapped by alloc_batch_wrap_vka,
+ * uses for the objects it does not batch, for timing a retype of each object.
+ * Objects allocated from unwrapped must be freed with it. Without
+ * CONFIG_SEL4TEST_BATCH_ALLOC this is a copy of vka. */
+void alloc_batch_unwrap_vka(vka_t *vka, vka_t *unwrapped);
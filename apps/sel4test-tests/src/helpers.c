@@ -185,7 +185,7 @@ int are_tcbs_distinct(seL4_CPtr tcb1, seL4_CPtr tcb2)
     return 0;
 }
 
-void create_helper_process_custom_asid(env_t env, helper_thread_t *thread, seL4_CPtr asid)
+void configure_helper_process(env_t env, helper_thread_t *thread, seL4_CPtr asid)
 {
     UNUSED int error;
 
@@ -193,6 +193,7 @@ void create_helper_process_custom_asid(env_t env, helper_thread_t *thread, seL4_
     assert(error == 0);
 
     thread->is_process = true;
+    thread->process_local_endpoint = seL4_CapNull;
 
     sel4utils_process_config_t config = process_config_default_simple(&env->simple, "", OUR_PRIO - 1);
     config = process_config_asid_pool(config, asid);
@@ -209,14 +210,59 @@ void create_helper_process_custom_asid(env_t env, helper_thread_t *thread, seL4_
     memcpy(thread->regions, env->regions, sizeof(sel4utils_elf_region_t) * env->num_regions);
     thread->num_regions = env->num_regions;
 
+    thread->thread = thread->process.thread;
+}
+
+/* first frame of each read only elf region, seL4_CapNull if it has to be copied */
+static seL4_CPtr elf_region_frames[MAX_REGIONS];
+
+void set_helper_elf_frames(UNUSED const seL4_CPtr *frames, UNUSED int num_regions)
+{
+#ifdef CONFIG_SEL4TEST_SHARE_HELPER_TEXT
+    assert(num_regions <= MAX_REGIONS);
+    memcpy(elf_region_frames, frames, sizeof(seL4_CPtr) * num_regions);
+#endif
+}
+
+/* map the frames of one of our read only elf regions into a helper process */
+static void share_into_helper_process(env_t env, helper_thread_t *thread, int region)
+{
+    UNUSED int error;
+    sel4utils_elf_region_t *elf_region = &thread->regions[region];
+    uintptr_t vaddr = ROUND_DOWN(elf_region->elf_vstart, PAGE_SIZE_4K);
+
+    for (size_t page = 0; page < ELF_REGION_PAGES(*elf_region); page++) {
+        /* each mapping needs its own cap, which the helper's vspace frees
+         * (without freeing the frame) when it is torn down */
+        seL4_CPtr frame = get_free_slot(env);
+        error = cnode_copy(env, elf_region_frames[region] + page, frame, seL4_AllRights);
+        assert(error == seL4_NoError);
+        error = vspace_map_pages_at_vaddr(&thread->process.vspace, &frame, NULL,
+                                          (void *)(vaddr + page * PAGE_SIZE_4K), 1, seL4_PageBits,
+                                          elf_region->reservation);
+        assert(error == 0);
+    }
+}
+
+void clone_into_helper_process(env_t env, helper_thread_t *thread)
+{
+    UNUSED int error;
+
     /* clone data/code into vspace */
-    for (int i = 0; i < env->num_regions; i++) {
+    for (int i = 0; i < thread->num_regions; i++) {
+        if (elf_region_frames[i] != seL4_CapNull) {
+            share_into_helper_process(env, thread, i);
+            continue;
+        }
         error = sel4utils_bootstrap_clone_into_vspace(&env->vspace, &thread->process.vspace, thread->regions[i].reservation);
         assert(error == 0);
     }
+}
 
-    thread->thread = thread->process.thread;
-    assert(error == 0);
+void create_helper_process_custom_asid(env_t env, helper_thread_t *thread, seL4_CPtr asid)
+{
+    configure_helper_process(env, thread, asid);
+    clone_into_helper_process(env, thread);
 }
 
 void create_helper_process(env_t env, helper_thread_t *thread)
@@ -270,10 +316,13 @@ void start_helper(env_t env, helper_thread_t *thread, helper_fn_t entry_point,
     seL4_CPtr local_endpoint;
 
     if (thread->is_process) {
-        /* copy the local endpoint */
-        cspacepath_t path;
-        vka_cspace_make_path(&env->vka, thread->local_endpoint.cptr, &path);
-        local_endpoint = sel4utils_copy_path_to_process(&thread->process, path);
+        /* copy the local endpoint, once, as the helper may be started again */
+        if (thread->process_local_endpoint == seL4_CapNull) {
+            cspacepath_t path;
+            vka_cspace_make_path(&env->vka, thread->local_endpoint.cptr, &path);
+            thread->process_local_endpoint = sel4utils_copy_path_to_process(&thread->process, path);
+        }
+        local_endpoint = thread->process_local_endpoint;
     } else {
         local_endpoint = thread->local_endpoint.cptr;
     }
@@ -390,6 +439,39 @@ void set_helper_affinity(UNUSED env_t env, helper_thread_t *thread, seL4_Word af
 #endif
 }
 
+void reset_helper(helper_thread_t *thread)
+{
+    /* this also aborts any IPC the helper is blocked on, including the call
+     * it makes to signal it has finished */
+    UNUSED int error = seL4_TCB_Suspend(thread->thread.tcb.cptr);
+    assert(error == seL4_NoError);
+}
+
+void create_helper_pool(env_t env, helper_thread_t *helpers, int num_helpers, bool is_process)
+{
+    for (int i = 0; i < num_helpers; i++) {
+        if (is_process) {
+            create_helper_process(env, &helpers[i]);
+        } else {
+            create_helper_thread(env, &helpers[i]);
+        }
+    }
+}
+
+void reset_helper_pool(helper_thread_t *helpers, int num_helpers)
+{
+    for (int i = 0; i < num_helpers; i++) {
+        reset_helper(&helpers[i]);
+    }
+}
+
+void cleanup_helper_pool(env_t env, helper_thread_t *helpers, int num_helpers)
+{
+    for (int i = 0; i < num_helpers; i++) {
+        cleanup_helper(env, &helpers[i]);
+    }
+}
+
 seL4_CPtr get_helper_tcb(helper_thread_t *thread)
 {
     return thread->thread.tcb.cptr;
@@ -439,6 +521,21 @@ static void sel4test_send_time_request(seL4_CPtr ep, uint64_t ns, sel4test_outpu
     seL4_Call(ep, tag);
 }
 
+static seL4_Word time_scale = 1;
+
+void set_helper_time_scale(seL4_Word scale)
+{
+    time_scale = scale > 0 ? scale : 1;
+}
+
+uint64_t scale_duration(uint64_t duration)
+{
+    if (duration == 0) {
+        return 0;
+    }
+    return MAX(duration / time_scale, (uint64_t) 1);
+}
+
 void sleep_busy(env_t env, uint64_t ns)
 {
     uint64_t start = sel4test_timestamp(env);
@@ -470,7 +567,7 @@ inline void sel4test_sleep(env_t env, uint64_t ns)
      * one thread can request/wait/sleep/wakeup on a time.
      */
 
-    sel4test_send_time_request(env->endpoint, ns, SEL4TEST_TIME_TIMEOUT, TIMEOUT_RELATIVE);
+    sel4test_send_time_request(env->endpoint, scale_duration(ns), SEL4TEST_TIME_TIMEOUT, TIMEOUT_RELATIVE);
     /* The tests have a timer_notification that they can wait on by default.
      * sel4-driver will notify us on timer_notification when it gets a timer interrupt
      */
@@ -479,7 +576,7 @@ inline void sel4test_sleep(env_t env, uint64_t ns)
 
 inline void sel4test_periodic_start(env_t env, uint64_t ns)
 {
-    sel4test_send_time_request(env->endpoint, ns, SEL4TEST_TIME_TIMEOUT, TIMEOUT_PERIODIC);
+    sel4test_send_time_request(env->endpoint, scale_duration(ns), SEL4TEST_TIME_TIMEOUT, TIMEOUT_PERIODIC);
 }
 
 uint64_t sel4test_timestamp(env_t env)
@@ -29,6 +29,33 @@
 
 #include <sel4test/test.h>
 
+/* Define one test for each parameter tuple in a table, so that each tuple is run,
+ * selected and reported as a test of its own. The table is a macro that applies
+ * its first argument to its second and each tuple, the first element of a tuple
+ * being the suffix of the test's name:
+ *
+ *     #define PRIO_PARAMS(P, t) P(t, LOW, 99) P(t, HIGH, 101)
+ *     static int test_prio(env_t env, int prio) { ... }
+ *     DEFINE_TEST_PARAM(PRIO0001, "Test a priority", test_prio, PRIO_PARAMS, true)
+ *
+ * defines PRIO0001_LOW and PRIO0001_HIGH, which return test_prio(env, 99) and
+ * test_prio(env, 101). The rest of the tuple is appended to the description.
+ * Names must still fit in TEST_NAME_MAX.
+ */
+#define DEFINE_TEST_PARAM(_name, _description, _function, _table, _enabled) \
+    _table(TEST_PARAM_CASE, (_name, _description, _function, _enabled))
+
+#define TEST_PARAM_CASE(_test, _suffix, ...) \
+    TEST_PARAM_APPLY(TEST_PARAM_DEFINE, (TEST_PARAM_UNWRAP _test, _suffix, __VA_ARGS__))
+#define TEST_PARAM_UNWRAP(...) __VA_ARGS__
+#define TEST_PARAM_APPLY(_macro, _args) _macro _args
+#define TEST_PARAM_DEFINE(_name, _description, _function, _enabled, _suffix, ...) \
+    static int _name##_##_suffix##_param(env_t env) \
+    { \
+        return _function(env, __VA_ARGS__); \
+    } \
+    DEFINE_TEST(_name##_##_suffix, _description " (" #__VA_ARGS__ ")", _name##_##_suffix##_param, _enabled)
+
 typedef int (*helper_fn_t)(seL4_Word, seL4_Word, seL4_Word, seL4_Word);
 
 typedef struct helper_thread {
@@ -46,6 +73,8 @@ typedef struct helper_thread {
     char args_strings[HELPER_THREAD_TOTAL_ARGS][WORD_STRING_SIZE];
 
     bool is_process;
+    /* the copy of local_endpoint in a helper process, made by the first start_helper */
+    seL4_CPtr process_local_endpoint;
 } helper_thread_t;
 
 /* Helper thread/process functions */
@@ -59,6 +88,13 @@ void create_helper_thread_custom_stack(env_t env, helper_thread_t *thread, size_
  * and a new cspace */
 void create_helper_process(env_t env, helper_thread_t *thread);
 void create_helper_process_custom_asid(env_t env, helper_thread_t *thread, seL4_CPtr asid);
+/* the two halves of create_helper_process_custom_asid: create the process with an
+ * empty vspace, then clone our loadable elf segments into it */
+void configure_helper_process(env_t env, helper_thread_t *thread, seL4_CPtr asid);
+void clone_into_helper_process(env_t env, helper_thread_t *thread);
+/* record the frames of the read only elf regions, from the init data, which
+ * clone_into_helper_process maps rather than copies */
+void set_helper_elf_frames(const seL4_CPtr *frames, int num_regions);
 /* create and start a passive thread */
 int create_passive_thread(env_t env, helper_thread_t *passive, helper_fn_t fn, seL4_CPtr ep,
                           seL4_Word arg1, seL4_Word arg2, seL4_Word arg3);
@@ -96,6 +132,19 @@ int wait_for_helper(helper_thread_t *thread);
 /* free all resources associated with a helper and tear it down */
 void cleanup_helper(env_t env, helper_thread_t *thread);
 
+/* Park a helper so that it can be given to start_helper again. The helper may have
+ * finished, be blocked or have faulted. Starting a parked helper only rewrites its
+ * registers and arguments, which is much cheaper than cleanup_helper followed by
+ * create_helper_*. Priority, affinity and scheduling parameters are kept, and a
+ * helper process keeps any changes its last run made to its copy of our data. */
+void reset_helper(helper_thread_t *thread);
+
+/* Helper pools: create helpers once and reset them between the iterations of a
+ * test, rather than creating and cleaning them up in every iteration. */
+void create_helper_pool(env_t env, helper_thread_t *helpers, int num_helpers, bool is_process);
+void reset_helper_pool(helper_thread_t *helpers, int num_helpers);
+void cleanup_helper_pool(env_t env, helper_thread_t *helpers, int num_helpers);
+
 /* retrieve the TCB of a helper thread */
 seL4_CPtr get_helper_tcb(helper_thread_t *thread);
 /* retrieve the reply object cap of a helper thread (seL4_CapNull if not CONFIG_RT_KERNEL) */
@@ -150,10 +199,17 @@ seL4_Word get_free_slot(env_t env);
  * threads performing waits */
 void sleep_busy(env_t env, uint64_t ns);
 
+/* record the time scale from the init data, see scale_duration */
+void set_helper_time_scale(seL4_Word scale);
+/* A duration divided by CONFIG_SEL4TEST_TIME_SCALE, but at least 1 if it was not 0.
+ * sel4test_sleep and sel4test_periodic_start scale their durations with this, tests
+ * that sleep in other ways, or set periods and budgets, scale them themselves. */
+uint64_t scale_duration(uint64_t duration);
+
 /* sel4test RPC helpers - sel4test-tests sel4test-tests requesting services from sel4test-driver*/
 
-/* Request a sleep for at least @ns. Callees to this function will block until
- * it's waken up and this function then returns. No concurrent calls to sel4test_sleep
+/* Request a sleep for at least @ns, scaled by scale_duration. Callees to this
+ * function will block until it's waken up and this function then returns. No concurrent calls to sel4test_sleep
  * are allowed, and trying to do this has undefined behavior.
  */
 void sel4test_sleep(env_t env, uint64_t ns);
@@ -163,7 +219,7 @@ void sel4test_sleep(env_t env, uint64_t ns);
  */
 uint64_t sel4test_timestamp(env_t env);
 
-/* Request periodic signals every @ns, at least.
+/* Request periodic signals every @ns, at least, scaled by scale_duration.
  * This function is similar to the sel4test_sleep function above,
  * but will get periodic notifications.
  *
@@ -5,6 +5,7 @@
  */
 
 #include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,6 +13,7 @@
 #include <arch_stdio.h>
 #include <allocman/vka.h>
 #include <allocman/bootstrap.h>
+#include <allocman/cspace/two_level.h>
 
 #include <sel4/sel4.h>
 #include <sel4/types.h>
@@ -26,6 +28,7 @@
 
 #include <vka/capops.h>
 
+#include "alloc_batch.h"
 #include "helpers.h"
 #include "test.h"
 #include "init.h"
@@ -70,30 +73,171 @@ static size_t write_buf(void *data, size_t count)
     return count;
 }
 
-static testcase_t *find_test(const char *name)
+static testcase_t *find_test(test_init_data_t *init_data)
 {
-    testcase_t *test = sel4test_get_test(name);
+    /* the index comes from the driver's view of the same section */
+    testcase_t *test = sel4test_get_test_by_index(init_data->test_index);
     if (test == NULL) {
-        ZF_LOGF("Failed to find test %s", name);
+        ZF_LOGF("Failed to find test %d", init_data->test_index);
     }
 
     return test;
 }
 
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+/* Resources allocated through env->vka by this test process. The allocman
+ * functions are wrapped so that every allocation and free is counted. Most
+ * tests never free anything and rely on the driver revoking their untypeds,
+ * so the peaks are usually the totals. With CONFIG_SEL4TEST_BATCH_ALLOC the
+ * objects handed out from a batch are not counted themselves, the untyped and
+ * the CNode of the batch are. */
+static struct {
+    /* the vka functions being wrapped */
+    vka_t base;
+    seL4_Word cslots;
+    seL4_Word peak_cslots;
+    seL4_Word untyped;
+    seL4_Word peak_untyped;
+    seL4_Word objects[seL4_ObjectTypeCount];
+    seL4_Word peak_objects[seL4_ObjectTypeCount];
+} resources;
+
+static void resources_add_untyped(seL4_Word type, seL4_Word size_bits)
+{
+    seL4_Word bytes = BIT(vka_get_object_size(type, size_bits));
+
+    resources.untyped += bytes;
+    resources.peak_untyped = MAX(resources.peak_untyped, resources.untyped);
+    if (type < seL4_ObjectTypeCount) {
+        resources.objects[type] += bytes;
+        resources.peak_objects[type] = MAX(resources.peak_objects[type], resources.objects[type]);
+    }
+}
+
+static int resources_cspace_alloc(void *data, seL4_CPtr *res)
+{
+    int error = resources.base.cspace_alloc(data, res);
+    if (!error) {
+        resources.cslots++;
+        resources.peak_cslots = MAX(resources.peak_cslots, resources.cslots);
+    }
+    return error;
+}
+
+static void resources_cspace_free(void *data, seL4_CPtr slot)
+{
+    resources.base.cspace_free(data, slot);
+    resources.cslots--;
+}
+
+static int resources_utspace_alloc(void *data, const cspacepath_t *dest, seL4_Word type, seL4_Word size_bits,
+                                   seL4_Word *res)
+{
+    int error = resources.base.utspace_alloc(data, dest, type, size_bits, res);
+    if (!error) {
+        resources_add_untyped(type, size_bits);
+    }
+    return error;
+}
+
+static int resources_utspace_alloc_maybe_device(void *data, const cspacepath_t *dest, seL4_Word type,
+                                                seL4_Word size_bits, bool can_use_dev, seL4_Word *res)
+{
+    int error = resources.base.utspace_alloc_maybe_device(data, dest, type, size_bits, can_use_dev, res);
+    if (!error) {
+        resources_add_untyped(type, size_bits);
+    }
+    return error;
+}
+
+static int resources_utspace_alloc_at(void *data, const cspacepath_t *dest, seL4_Word type, seL4_Word size_bits,
+                                      uintptr_t paddr, seL4_Word *cookie)
+{
+    int error = resources.base.utspace_alloc_at(data, dest, type, size_bits, paddr, cookie);
+    if (!error) {
+        resources_add_untyped(type, size_bits);
+    }
+    return error;
+}
+
+static void resources_utspace_free(void *data, seL4_Word type, seL4_Word size_bits, seL4_Word target)
+{
+    seL4_Word bytes = BIT(vka_get_object_size(type, size_bits));
+
+    resources.base.utspace_free(data, type, size_bits, target);
+    resources.untyped -= bytes;
+    if (type < seL4_ObjectTypeCount) {
+        resources.objects[type] -= bytes;
+    }
+}
+
+static void resources_wrap_vka(vka_t *vka)
+{
+    resources.base = *vka;
+    vka->cspace_alloc = resources_cspace_alloc;
+    vka->cspace_free = resources_cspace_free;
+    vka->utspace_alloc = resources_utspace_alloc;
+    vka->utspace_alloc_maybe_device = resources_utspace_alloc_maybe_device;
+    vka->utspace_alloc_at = resources_utspace_alloc_at;
+    vka->utspace_free = resources_utspace_free;
+}
+
+static seL4_Word resources_set_mrs(void)
+{
+    seL4_SetMR(SEL4TEST_RESULT_PEAK_CSLOTS_MR, resources.peak_cslots);
+    seL4_SetMR(SEL4TEST_RESULT_PEAK_UNTYPED_MR, resources.peak_untyped);
+    for (int i = 0; i < seL4_ObjectTypeCount; i++) {
+        seL4_SetMR(SEL4TEST_RESULT_PEAK_OBJECTS_MR + i, resources.peak_objects[i]);
+    }
+    return SEL4TEST_RESULT_LENGTH;
+}
+#endif /* CONFIG_SEL4TEST_REPORT_RESOURCES */
+
 static void init_allocator(env_t env, test_init_data_t *init_data)
 {
     UNUSED int error;
     UNUSED reservation_t virtual_reservation;
 
     /* initialise allocator */
-    allocman_t *allocator = bootstrap_use_current_1level(init_data->root_cnode,
-                                                         init_data->cspace_size_bits, init_data->free_slots.start,
-                                                         init_data->free_slots.end, ALLOCATOR_STATIC_POOL_SIZE,
-                                                         allocator_mem_pool);
+    allocman_t *allocator = bootstrap_create_allocman(ALLOCATOR_STATIC_POOL_SIZE, allocator_mem_pool);
     if (allocator == NULL) {
         ZF_LOGF("Failed to bootstrap allocator");
     }
+
+    /* The driver gives us a two-level cspace with only the first level two
+     * cnode in place. The allocator creates the others when it runs out of
+     * slots, from the untypeds added below. */
+    cspace_two_level_t *cspace = allocman_mspace_alloc(allocator, sizeof(*cspace), &error);
+    if (error) {
+        ZF_LOGF("Failed to allocate cspace for allocator");
+    }
+    error = cspace_two_level_create(allocator, cspace, (struct cspace_two_level_config) {
+        .cnode = init_data->root_cnode,
+        .cnode_size_bits = TEST_PROCESS_CSPACE_L1_BITS,
+        .cnode_guard_bits = seL4_WordBits - init_data->cspace_size_bits,
+        .first_slot = 1,
+        .end_slot = BIT(TEST_PROCESS_CSPACE_L1_BITS),
+        .level_two_bits = TEST_PROCESS_CSPACE_L2_BITS,
+        .start_existing_index = 0,
+        .end_existing_index = 1,
+        .start_existing_slot = init_data->free_slots.start,
+        .end_existing_slot = init_data->free_slots.end
+    });
+    if (error) {
+        ZF_LOGF("Failed to create two-level cspace");
+    }
+    error = allocman_attach_cspace(allocator, cspace_two_level_make_interface(cspace));
+    if (error) {
+        ZF_LOGF("Failed to attach cspace to allocator");
+    }
     allocman_make_vka(&env->vka, allocator);
+    /* Resources are counted below the batches, so that what is reported is the
+     * untypeds and CNodes the batches are retyped from, not the objects they
+     * hand out. */
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+    resources_wrap_vka(&env->vka);
+#endif
+    alloc_batch_wrap_vka(&env->vka);
 
     /* fill the allocator with untypeds */
     seL4_CPtr slot;
@@ -207,6 +351,8 @@ int main(int argc, char **argv)
     env.cores = init_data->cores;
     env.num_regions = init_data->num_elf_regions;
     memcpy(env.regions, init_data->elf_regions, sizeof(sel4utils_elf_region_t) * env.num_regions);
+    set_helper_elf_frames(init_data->elf_region_frames, env.num_regions);
+    set_helper_time_scale(init_data->time_scale);
 
     env.timer_notification.cptr = init_data->timer_ntfn;
 
@@ -222,7 +368,7 @@ int main(int argc, char **argv)
     sel4rpc_client_init(&env.rpc_client, env.endpoint, SEL4TEST_PROTOBUF_RPC);
 
     /* find the test */
-    testcase_t *test = find_test(init_data->name);
+    testcase_t *test = find_test(init_data);
 
     /* run the test */
     sel4test_reset();
@@ -232,13 +378,17 @@ int main(int argc, char **argv)
         result = test->function((uintptr_t)&env);
     } else {
         result = FAILURE;
-        ZF_LOGF("Cannot find test %s\n", init_data->name);
+        ZF_LOGF("Cannot find test %d\n", init_data->test_index);
     }
 
-    printf("Test %s %s\n", init_data->name, result == SUCCESS ? "passed" : "failed");
+    printf("Test %s %s\n", test->name, result == SUCCESS ? "passed" : "failed");
     /* send our result back */
-    seL4_MessageInfo_t info = seL4_MessageInfo_new(seL4_Fault_NullFault, 0, 0, 1);
-    seL4_SetMR(0, result);
+    seL4_Word length = 1;
+#ifdef CONFIG_SEL4TEST_REPORT_RESOURCES
+    length = resources_set_mrs();
+#endif
+    seL4_MessageInfo_t info = seL4_MessageInfo_new(seL4_Fault_NullFault, 0, 0, length);
+    seL4_SetMR(SEL4TEST_RESULT_MR, result);
     seL4_Send(endpoint, info);
 
     /* It is expected that we are torn down by the test driver before we are
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <utils/util.h>
+
+#include "helpers.h"
+#include "perf.h"
+
+/* number of timestamp pairs to take the minimum over */
+#define PERF_OVERHEAD_SAMPLES 32
+
+void perf_stats_init(perf_stats_t *stats)
+{
+    stats->min = UINT64_MAX;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->count = 0;
+}
+
+void perf_stats_add(perf_stats_t *stats, uint64_t sample)
+{
+    stats->min = MIN(stats->min, sample);
+    stats->max = MAX(stats->max, sample);
+    stats->sum += sample;
+    stats->count++;
+}
+
+uint64_t perf_stats_mean(perf_stats_t *stats)
+{
+    if (stats->count == 0) {
+        return 0;
+    }
+    return stats->sum / stats->count;
+}
+
+void perf_stats_print(const char *test, const char *variant, seL4_Word param, perf_stats_t *stats)
+{
+    printf("PERF %s %s %lu: n=%lu min=%llu mean=%llu max=%llu\n", test, variant, (unsigned long) param,
+           (unsigned long) stats->count, (unsigned long long)(stats->count ? stats->min : 0),
+           (unsigned long long) perf_stats_mean(stats), (unsigned long long) stats->max);
+}
+
+void perf_print(const char *test, const char *variant, seL4_Word param, const char *metric, uint64_t value)
+{
+    printf("PERF %s %s %lu: %s=%llu\n", test, variant, (unsigned long) param, metric,
+           (unsigned long long) value);
+}
+
+uint64_t perf_timestamp_overhead(env_t env)
+{
+    uint64_t overhead = UINT64_MAX;
+
+    for (int i = 0; i < PERF_OVERHEAD_SAMPLES; i++) {
+        uint64_t start = sel4test_timestamp(env);
+        uint64_t end = sel4test_timestamp(env);
+        overhead = MIN(overhead, end - start);
+    }
+
+    return overhead;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <sel4/sel4.h>
+#include <sel4test/test.h>
+
+/* Helpers for the PERF tests (enabled by CONFIG_SEL4TEST_PERF).
+ *
+ * PERF tests measure something instead of (only) checking it. Each result is
+ * printed as a single line so it can be picked out of the log:
+ *
+ *   PERF <test> <variant> <param>: n=<samples> min=<min> mean=<mean> max=<max>
+ *   PERF <test> <variant> <param>: <metric>=<value>
+ *
+ * All times are in nanoseconds, as returned by sel4test_timestamp. */
+
+typedef struct perf_stats {
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+    seL4_Word count;
+} perf_stats_t;
+
+void perf_stats_init(perf_stats_t *stats);
+void perf_stats_add(perf_stats_t *stats, uint64_t sample);
+uint64_t perf_stats_mean(perf_stats_t *stats);
+
+/* print the summary of a set of samples */
+void perf_stats_print(const char *test, const char *variant, seL4_Word param, perf_stats_t *stats);
+/* print a single named value */
+void perf_print(const char *test, const char *variant, seL4_Word param, const char *metric, uint64_t value);
+
+/* Estimate the cost of a back to back pair of sel4test_timestamp calls. This is
+ * an RPC to sel4test-driver, so it is not negligible when timing short operations
+ * and should be subtracted from each sample. */
+uint64_t perf_timestamp_overhead(env_t env);
+
+/* subtract the timestamp overhead from a sample without wrapping */
+static inline uint64_t perf_sample(uint64_t start, uint64_t end, uint64_t overhead)
+{
+    uint64_t diff = end - start;
+    return diff > overhead ? diff - overhead : 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <string.h>
+
+#include "serial_batch.h"
+
+void serial_batch_init(serial_batch_t *batch, serial_client_context_t *conn)
+{
+    batch->conn = conn;
+    batch->len = 0;
+}
+
+int serial_batch_flush(serial_batch_t *batch)
+{
+    int error;
+
+    if (batch->len == 0) {
+        return 0;
+    }
+    error = serial_server_write(batch->conn, batch->buf, batch->len);
+    if (error != batch->len) {
+        return -1;
+    }
+    batch->len = 0;
+    return 0;
+}
+
+int serial_batch_write(serial_batch_t *batch, const char *str, size_t len)
+{
+    int error;
+
+    if (batch->len + len > SERIAL_BATCH_BUF_SIZE) {
+        error = serial_batch_flush(batch);
+        if (error != 0) {
+            return error;
+        }
+    }
+    if (len > SERIAL_BATCH_BUF_SIZE) {
+        error = serial_server_write(batch->conn, str, len);
+        return (error == len) ? 0 : -1;
+    }
+    memcpy(&batch->buf[batch->len], str, len);
+    batch->len += len;
+    return 0;
+}
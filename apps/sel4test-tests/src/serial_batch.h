@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026, seL4 Project a Series of LF Projects, LLC
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stddef.h>
+#include <serial_server/client.h>
+
+/* Batched writes to the serial server.
+ *
+ * serial_server_write() copies the caller's buffer into the page shared with
+ * the Server at connect time and then makes one IPC per call, so for a client
+ * making many small writes the IPC dominates. serial_batch_t gathers small
+ * writes locally and hands them to serial_server_write() together, when the
+ * buffer fills up or when the client flushes it. The buffer is kept well below
+ * the size of the shared page.
+ *
+ * This is a model of batching in the client, as the serial server client
+ * library is part of seL4_libs. */
+
+#define SERIAL_BATCH_BUF_SIZE 512
+
+typedef struct serial_batch {
+    serial_client_context_t *conn;
+    size_t len;
+    char buf[SERIAL_BATCH_BUF_SIZE];
+} serial_batch_t;
+
+/* start an empty batch of writes to conn, which must be connected */
+void serial_batch_init(serial_batch_t *batch, serial_client_context_t *conn);
+
+/** Sends everything gathered so far to the Server in a single write().
+ * @return 0 on success; non-zero on error.
+ */
+int serial_batch_flush(serial_batch_t *batch);
+
+/** Queues "len" bytes of "str" to be written, flushing first if they don't
+ * fit. Writes too large for the buffer are passed straight through.
+ * @return 0 on success; non-zero on error.
+ */
+int serial_batch_write(serial_batch_t *batch, const char *str, size_t len);
@@ -54,4 +54,6 @@ static int test_benchmark_utilisation(env_t env)
 }
 DEFINE_TEST(BENCHMARK_0001, "Test seL4 Benchmarking API - Utilisation", test_benchmark_utilisation,
             config_set(CONFIG_HAVE_TIMER));
+/* sleeps for a second */
+DEFINE_TEST_BUDGET(BENCHMARK_0001, 1000, TEST_BUDGET_SCALED)
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
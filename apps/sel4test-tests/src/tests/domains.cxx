@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 /* Our headers are not C++ friendly */
 extern "C" {
@@ -17,11 +18,26 @@ extern "C" {
 #include <sel4/sel4.h>
 
 #include "../helpers.h"
+#include "../perf.h"
 
 }
 
 #define POLL_DELAY_NS 4000000
 
+/* domain schedule lengths are in ticks, except on MCS where they are in ms */
+#ifdef CONFIG_KERNEL_MCS
+#define DOMAIN_LENGTH_MS 1
+#else
+#define DOMAIN_LENGTH_MS CONFIG_TIMER_TICK_MS
+#endif
+/* at least one pass of the default schedule in domain_schedule.c */
+#define DOMAINS_DEFAULT_SCHEDULE_MS ((60 + 4 * (CONFIG_NUM_DOMAINS - 1)) * DOMAIN_LENGTH_MS)
+/* The threads outside domain 0 wait for the driver, in domain 0, to answer each
+ * of their timestamps, so each of their 50 polls takes a few passes of the
+ * schedule. */
+#define DOMAINS_RUN_BUDGET_MS (CONFIG_NUM_DOMAINS > 1 ? 50 * 3 * DOMAINS_DEFAULT_SCHEDULE_MS : \
+                               50 * POLL_DELAY_NS / NS_IN_MS + 10)
+
 typedef int (*test_func_t)(seL4_Word /* id */, env_t env /* env */);
 
 static int
@@ -59,7 +75,7 @@ int fdom1(seL4_Word id, env_t env)
     int countdown = 50;
 
     while (countdown > 0) {
-        sleep_busy(env, POLL_DELAY_NS);
+        sleep_busy(env, scale_duration(POLL_DELAY_NS));
         --countdown;
         ZF_LOGD("%2d, ", (int)id);
     }
@@ -115,6 +131,7 @@ test_run_domains(struct env* env)
     return test_domains<false>(env, fdom1);
 }
 DEFINE_TEST(DOMAINS0004, "Run threads in domains()", test_run_domains, config_set(CONFIG_HAVE_TIMER))
+DEFINE_TEST_BUDGET(DOMAINS0004, DOMAINS_RUN_BUDGET_MS, TEST_BUDGET_FIXED)
 
 /* The output of this test differs from that of DOMAINS0004 in that the thread
  * in domain 0 is moved into domain 1 after a short delay. This should be
@@ -132,6 +149,7 @@ test_run_domains_shift(struct env* env)
     return test_domains<true>(env, fdom1);
 }
 DEFINE_TEST(DOMAINS0005, "Move thread between domains()", test_run_domains_shift, config_set(CONFIG_HAVE_TIMER) && CONFIG_NUM_DOMAINS > 1)
+DEFINE_TEST_BUDGET(DOMAINS0005, DOMAINS_RUN_BUDGET_MS, TEST_BUDGET_FIXED)
 
 static int
 test_own_domain1(struct env* env)
@@ -153,3 +171,183 @@ test_own_domain3(struct env* env)
     return own_domain_badcap(env);
 }
 DEFINE_TEST(DOMAINS0003, "Invoke non-domain cap()", test_own_domain3, true)
+
+/* Number of domain 0 slices DOMAINS_PERF0001 records */
+#define DOMAIN_PERF_SLICES 50
+/* Give up if the slices have not been seen in this long */
+#define DOMAIN_PERF_TIMEOUT_NS (60 * NS_IN_S)
+/* A jump in time larger than this means domain 0 was switched out. This is well
+ * below the shortest possible domain length, and well above an RPC or an
+ * interrupt handled by the driver. */
+#define DOMAIN_PERF_GAP_NS (200 * NS_IN_US)
+/* The spinners are calibrated by timing chunks of this many spins, short enough
+ * to fit well within DOMAIN_PERF_GAP_NS, so that a chunk that took longer than
+ * that is known to have been switched out and can be thrown away. */
+#define DOMAIN_PERF_CALIBRATION_SPINS 10000
+#define DOMAIN_PERF_CALIBRATION_CHUNKS 100
+
+#define DOMAIN_PERF_LENGTH_NS ((uint64_t) DOMAIN_LENGTH_MS * NS_IN_MS)
+
+static int
+domain_perf_spinner(seL4_Word counter_vaddr)
+{
+    volatile seL4_Word *counter = (volatile seL4_Word *) counter_vaddr;
+
+    while (1) {
+        (*counter)++;
+    }
+
+    return 0;
+}
+
+/* Parse CONFIG_DOMAIN_SCHEDULE into the total time each domain is scheduled for
+ * in one pass of the schedule. Returns the length of the whole schedule in ns, or
+ * 0 if the kernel was built with the default schedule. */
+static uint64_t
+domain_perf_parse_schedule(uint64_t lengths[CONFIG_NUM_DOMAINS])
+{
+    uint64_t period = 0;
+
+    for (int i = 0; i < CONFIG_NUM_DOMAINS; i++) {
+        lengths[i] = 0;
+    }
+
+#ifdef CONFIG_DOMAIN_SCHEDULE
+    const char *schedule = CONFIG_DOMAIN_SCHEDULE;
+
+    while (*schedule != '\0') {
+        char *end;
+        unsigned long domain = strtoul(schedule, &end, 10);
+        ZF_LOGF_IF(*end != ':' || domain >= CONFIG_NUM_DOMAINS, "Invalid domain schedule %s", CONFIG_DOMAIN_SCHEDULE);
+        unsigned long length = strtoul(end + 1, &end, 10);
+        ZF_LOGF_IF(*end != ',' && *end != '\0', "Invalid domain schedule %s", CONFIG_DOMAIN_SCHEDULE);
+
+        lengths[domain] += length * DOMAIN_PERF_LENGTH_NS;
+        period += length * DOMAIN_PERF_LENGTH_NS;
+        schedule = (*end == ',') ? end + 1 : end;
+    }
+#endif
+
+    return period;
+}
+
+/*
+ * Measure how closely the kernel follows the domain schedule, and how much time
+ * is lost switching domains.
+ *
+ * Only domain 0 can use the driver for time, so we watch from domain 0 for the
+ * gaps where other domains run, while a spinner in every other domain counts how
+ * much it gets to run. The spinners are calibrated here first, which turns their
+ * counts into time.
+ */
+static int
+test_domain_schedule_fidelity(struct env *env)
+{
+    helper_thread_t spinners[CONFIG_NUM_DOMAINS];
+    volatile seL4_Word counters[CONFIG_NUM_DOMAINS] = {0};
+    seL4_Word start_counts[CONFIG_NUM_DOMAINS];
+    uint64_t expected[CONFIG_NUM_DOMAINS];
+    int error;
+
+    uint64_t overhead = perf_timestamp_overhead(env);
+    uint64_t schedule_period = domain_perf_parse_schedule(expected);
+
+    /* Time spins in domain 0. Other domains still get their slots, so like the
+     * main loop below we ignore any chunk that spans a domain switch, and keep the
+     * fastest of the rest. */
+    uint64_t spin_ns = UINT64_MAX;
+    for (int chunk = 0; chunk < DOMAIN_PERF_CALIBRATION_CHUNKS; chunk++) {
+        uint64_t start = sel4test_timestamp(env);
+        for (seL4_Word i = 0; i < DOMAIN_PERF_CALIBRATION_SPINS; i++) {
+            counters[0]++;
+        }
+        uint64_t elapsed = sel4test_timestamp(env) - start;
+        if (elapsed <= DOMAIN_PERF_GAP_NS) {
+            spin_ns = MIN(spin_ns, MAX(elapsed - MIN(elapsed, overhead), (uint64_t) 1));
+        }
+    }
+    test_assert(spin_ns != UINT64_MAX);
+    counters[0] = 0;
+
+    for (int i = 1; i < CONFIG_NUM_DOMAINS; i++) {
+        create_helper_thread(env, &spinners[i]);
+        error = seL4_DomainSet_Set(env->domain, (seL4_Word) i, get_helper_tcb(&spinners[i]));
+        test_check(error == seL4_NoError);
+        start_helper(env, &spinners[i], (helper_fn_t) domain_perf_spinner, (seL4_Word) &counters[i], 0, 0, 0);
+    }
+
+    perf_stats_t slices, gaps;
+    perf_stats_init(&slices);
+    perf_stats_init(&gaps);
+
+    /* The first slice is partial, so we start measuring at the first gap, and
+     * stop at the end of a gap so that the window covers whole slices and gaps. */
+    bool measuring = false;
+    uint64_t window_start = 0;
+    uint64_t slice_start = 0;
+    uint64_t begin = sel4test_timestamp(env);
+    uint64_t last = begin;
+    while (slices.count < DOMAIN_PERF_SLICES && last - begin < DOMAIN_PERF_TIMEOUT_NS) {
+        uint64_t now = sel4test_timestamp(env);
+        if (now - last > DOMAIN_PERF_GAP_NS) {
+            /* other domains cannot run until we are switched out again */
+            if (measuring) {
+                perf_stats_add(&slices, last - slice_start);
+                perf_stats_add(&gaps, now - last);
+            } else {
+                measuring = true;
+                window_start = now;
+                for (int i = 1; i < CONFIG_NUM_DOMAINS; i++) {
+                    start_counts[i] = counters[i];
+                }
+            }
+            slice_start = now;
+        }
+        last = now;
+    }
+    uint64_t window = slice_start - window_start;
+
+    for (int i = 1; i < CONFIG_NUM_DOMAINS; i++) {
+        seL4_TCB_Suspend(get_helper_tcb(&spinners[i]));
+    }
+
+    test_check(slices.count == DOMAIN_PERF_SLICES);
+
+    perf_stats_print("DOMAINS_PERF0001", "domain0_slice", 0, &slices);
+    perf_stats_print("DOMAINS_PERF0001", "domain0_gap", 0, &gaps);
+    perf_print("DOMAINS_PERF0001", "window", 0, "ns", window);
+
+    /* domain 0 time is what we saw, other domains' is from their spin counts */
+    for (int i = 0; i < CONFIG_NUM_DOMAINS; i++) {
+        uint64_t observed = slices.sum;
+        if (i > 0) {
+            observed = (uint64_t)(counters[i] - start_counts[i]) * spin_ns / DOMAIN_PERF_CALIBRATION_SPINS;
+        }
+        perf_print("DOMAINS_PERF0001", "domain_time", i, "observed_ns", observed);
+        if (schedule_period != 0) {
+            perf_print("DOMAINS_PERF0001", "domain_time", i, "expected_ns", window * expected[i] / schedule_period);
+        }
+    }
+
+    /* Every slice of domain 0 is bracketed by two domain switches, and the time
+     * they take comes out of the slice, so compare what we saw with what we
+     * should have had. This also absorbs the one timestamp we lose at each end. */
+    if (schedule_period != 0 && slices.count > 0) {
+        uint64_t expected_domain0 = window * expected[0] / schedule_period;
+        uint64_t lost = expected_domain0 > slices.sum ? expected_domain0 - slices.sum : 0;
+        uint64_t per_switch = lost / (2 * slices.count);
+        perf_print("DOMAINS_PERF0001", "switch", 0, "overhead_ns", per_switch > overhead ? per_switch - overhead : 0);
+    } else {
+        printf("DOMAINS_PERF0001: default schedule, set Sel4testDomainSchedule to compare against expected times\n");
+    }
+
+    for (int i = 1; i < CONFIG_NUM_DOMAINS; i++) {
+        cleanup_helper(env, &spinners[i]);
+    }
+
+    return sel4test_get_result();
+}
+DEFINE_TEST(DOMAINS_PERF0001, "Measure domain schedule fidelity and switch overhead", test_domain_schedule_fidelity,
+            config_set(CONFIG_SEL4TEST_PERF) && config_set(CONFIG_HAVE_TIMER) && CONFIG_NUM_DOMAINS > 1)
+/* DOMAIN_PERF_SLICES passes of the schedule, with the default schedule */
+DEFINE_TEST_BUDGET(DOMAINS_PERF0001, DOMAIN_PERF_SLICES * DOMAINS_DEFAULT_SCHEDULE_MS, TEST_BUDGET_FIXED)
@@ -8,6 +8,7 @@
 #include <sel4test-driver/gen_config.h>
 
 #include "../helpers.h"
+#include "../perf.h"
 
 static double fpu_calculation(void)
 {
@@ -188,3 +189,87 @@ int smp_test_fpu(env_t env)
 }
 DEFINE_TEST(FPU0002, "Test FPU remain valid across core migration", smp_test_fpu,
             config_set(CONFIG_MAX_NUM_NODES) &&config_set(CONFIG_HAVE_TIMER) &&CONFIG_MAX_NUM_NODES > 1)
+
+/* Threads taking part in each run of FPU_PERF0001 */
+#define FPU_PERF_THREADS 8
+/* Yields each thread does per run */
+#define FPU_PERF_ROUNDS 1000
+
+static inline void fpu_perf_op(volatile double *state)
+{
+    /* enough to make the thread the FPU owner, but no more */
+    *state = *state * 1.000001 + 0.5;
+}
+
+static int fpu_perf_worker(seL4_Word use_fpu, seL4_Word state_vaddr)
+{
+    volatile double *state = (volatile double *) state_vaddr;
+
+    for (int i = 0; i < FPU_PERF_ROUNDS; i++) {
+        if (use_fpu) {
+            fpu_perf_op(state);
+        }
+        seL4_Yield();
+    }
+
+    return 0;
+}
+
+/*
+ * Measure the cost of a context switch as the number of threads that use the
+ * FPU between switches goes from 0 to FPU_PERF_THREADS.
+ *
+ * All the helpers run round robin at the same priority, yielding to each other,
+ * so every yield switches to a thread that may need its FPU state restored.
+ */
+static int test_fpu_context_switch_cost(env_t env)
+{
+    helper_thread_t threads[FPU_PERF_THREADS];
+    volatile double state[FPU_PERF_THREADS];
+    volatile double scratch = 1.0;
+
+    uint64_t overhead = perf_timestamp_overhead(env);
+
+    /* cost of the floating point work itself, to take out of the results */
+    uint64_t start = sel4test_timestamp(env);
+    for (int i = 0; i < FPU_PERF_ROUNDS; i++) {
+        fpu_perf_op(&scratch);
+    }
+    uint64_t op_ns = perf_sample(start, sel4test_timestamp(env), overhead);
+
+    uint64_t baseline = 0;
+    for (int fpu_threads = 0; fpu_threads <= FPU_PERF_THREADS; fpu_threads++) {
+        /* helpers are created below our priority, so none of them run until we block */
+        for (int i = 0; i < FPU_PERF_THREADS; i++) {
+            state[i] = 1.0;
+            create_helper_thread(env, &threads[i]);
+            start_helper(env, &threads[i], (helper_fn_t) fpu_perf_worker, i < fpu_threads,
+                         (seL4_Word) &state[i], 0, 0);
+        }
+
+        start = sel4test_timestamp(env);
+        for (int i = 0; i < FPU_PERF_THREADS; i++) {
+            wait_for_helper(&threads[i]);
+        }
+        uint64_t total = perf_sample(start, sel4test_timestamp(env), overhead);
+
+        uint64_t work = op_ns * fpu_threads;
+        uint64_t per_switch = (total > work ? total - work : 0) / (FPU_PERF_THREADS * FPU_PERF_ROUNDS);
+        if (fpu_threads == 0) {
+            baseline = per_switch;
+        }
+        perf_print("FPU_PERF0001", "switch", fpu_threads, "ns", per_switch);
+        perf_print("FPU_PERF0001", "fpu_cost", fpu_threads, "ns", per_switch > baseline ? per_switch - baseline : 0);
+
+        for (int i = 0; i < FPU_PERF_THREADS; i++) {
+            cleanup_helper(env, &threads[i]);
+        }
+    }
+
+    return sel4test_get_result();
+}
+DEFINE_TEST(FPU_PERF0001, "Measure context switch cost with varying numbers of FPU threads",
+            test_fpu_context_switch_cost,
+            config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER) &&config_set(CONFIG_HAVE_FPU))
+/* FPU_PERF_THREADS + 1 runs, each creating FPU_PERF_THREADS helper threads */
+DEFINE_TEST_BUDGET(FPU_PERF0001, (FPU_PERF_THREADS + 1) * FPU_PERF_THREADS * 5, TEST_BUDGET_FIXED)
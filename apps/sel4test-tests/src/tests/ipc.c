@@ -272,9 +272,22 @@ static int nbsendrecv_func(seL4_Word endpoint, seL4_Word seed, seL4_Word reply,
 }
 #endif /* CONFIG_KERNEL_MCS */
 
-static int test_ipc_pair(env_t env, test_func_t fa, test_func_t fb, bool inter_as, seL4_Word nr_cores)
+#define IPC_PAIR_WAITER_PRIO 100
+
+/* The priority of the sender relative to the waiter, and which of them is
+ * started first, for each of the IPC pair tests */
+#define IPC_PAIR_PARAMS(P, t) \
+    P(t, P98_W, 98, false) P(t, P98_S, 98, true) \
+    P(t, P99_W, 99, false) P(t, P99_S, 99, true) \
+    P(t, P100_W, 100, false) P(t, P100_S, 100, true) \
+    P(t, P101_W, 101, false) P(t, P101_S, 101, true) \
+    P(t, P102_W, 102, false) P(t, P102_S, 102, true)
+
+static int test_ipc_pair(env_t env, test_func_t fa, test_func_t fb, bool inter_as, seL4_Word nr_cores,
+                         int sender_prio, bool sender_first)
 {
-    helper_thread_t thread_a, thread_b;
+    helper_thread_t helpers[2];
+    helper_thread_t *thread_a = &helpers[0], *thread_b = &helpers[1];
     vka_t *vka = &env->vka;
 
     UNUSED int error;
@@ -284,143 +297,137 @@ static int test_ipc_pair(env_t env, test_func_t fa, test_func_t fb, bool inter_a
     seL4_CPtr a_reply = vka_alloc_reply_leaky(vka);
     seL4_CPtr b_reply = vka_alloc_reply_leaky(vka);
 
+    /* The same pair of helpers is reused for every combination below */
+    seL4_Word thread_a_arg0, thread_b_arg0;
+    seL4_CPtr thread_a_reply, thread_b_reply;
+
+    create_helper_pool(env, helpers, ARRAY_SIZE(helpers), inter_as);
+    if (inter_as) {
+        cspacepath_t path;
+        vka_cspace_make_path(&env->vka, ep, &path);
+        thread_a_arg0 = sel4utils_copy_path_to_process(&thread_a->process, path);
+        assert(thread_a_arg0 != -1);
+        thread_b_arg0 = sel4utils_copy_path_to_process(&thread_b->process, path);
+        assert(thread_b_arg0 != -1);
+
+        if (config_set(CONFIG_KERNEL_MCS)) {
+            thread_a_reply = sel4utils_copy_cap_to_process(&thread_a->process, vka, a_reply);
+            thread_b_reply = sel4utils_copy_cap_to_process(&thread_b->process, vka, b_reply);
+        }
+    } else {
+        thread_a_arg0 = ep;
+        thread_b_arg0 = ep;
+        thread_a_reply = a_reply;
+        thread_b_reply = b_reply;
+    }
+
     /* Test sending messages of varying lengths. */
-    /* Please excuse the awful indending here. */
     for (int core_a = 0; core_a < nr_cores; core_a++) {
         for (int core_b = 0; core_b < nr_cores; core_b++) {
-            for (int sender_prio = 98; sender_prio <= 102; sender_prio++) {
-                for (int waiter_prio = 100; waiter_prio <= 100; waiter_prio++) {
-                    for (int sender_first = 0; sender_first <= 1; sender_first++) {
-                        ZF_LOGD("%d %s %d\n",
-                                sender_prio, sender_first ? "->" : "<-", waiter_prio);
-                        seL4_Word thread_a_arg0, thread_b_arg0;
-                        seL4_CPtr thread_a_reply, thread_b_reply;
-
-                        if (inter_as) {
-                            create_helper_process(env, &thread_a);
-
-                            cspacepath_t path;
-                            vka_cspace_make_path(&env->vka, ep, &path);
-                            thread_a_arg0 = sel4utils_copy_path_to_process(&thread_a.process, path);
-                            assert(thread_a_arg0 != -1);
-
-                            create_helper_process(env, &thread_b);
-                            thread_b_arg0 = sel4utils_copy_path_to_process(&thread_b.process, path);
-                            assert(thread_b_arg0 != -1);
-
-                            if (config_set(CONFIG_KERNEL_MCS)) {
-                                thread_a_reply = sel4utils_copy_cap_to_process(&thread_a.process, vka, a_reply);
-                                thread_b_reply = sel4utils_copy_cap_to_process(&thread_b.process, vka, b_reply);
-                            }
-                        } else {
-                            create_helper_thread(env, &thread_a);
-                            create_helper_thread(env, &thread_b);
-                            thread_a_arg0 = ep;
-                            thread_b_arg0 = ep;
-                            thread_a_reply = a_reply;
-                            thread_b_reply = b_reply;
-                        }
-
-                        set_helper_priority(env, &thread_a, sender_prio);
-                        set_helper_priority(env, &thread_b, waiter_prio);
-
-                        set_helper_affinity(env, &thread_a, core_a);
-                        set_helper_affinity(env, &thread_b, core_b);
-
-                        /* Set the flag for nbwait_func that tells it whether or not it really
-                         * should wait. */
-                        int nbwait_should_wait;
-                        nbwait_should_wait =
-                            (sender_prio < waiter_prio);
-
-                        /* Threads are enqueued at the head of the scheduling queue, so the
-                         * thread enqueued last will be run first, for a given priority. */
-                        if (sender_first) {
-                            start_helper(env, &thread_b, (helper_fn_t) fb, thread_b_arg0, start_number,
-                                         thread_b_reply, nbwait_should_wait);
-                            start_helper(env, &thread_a, (helper_fn_t) fa, thread_a_arg0, start_number,
-                                         thread_a_reply, nbwait_should_wait);
-                        } else {
-                            start_helper(env, &thread_a, (helper_fn_t) fa, thread_a_arg0, start_number,
-                                         thread_a_reply, nbwait_should_wait);
-                            start_helper(env, &thread_b, (helper_fn_t) fb, thread_b_arg0, start_number,
-                                         thread_b_reply, nbwait_should_wait);
-                        }
-
-                        test_result_t res = wait_for_helper(&thread_a);
-                        test_eq(res, SUCCESS);
-                        res = wait_for_helper(&thread_b);
-                        test_eq(res, SUCCESS);
-
-                        cleanup_helper(env, &thread_a);
-                        cleanup_helper(env, &thread_b);
-
-                        start_number += 0x71717171;
-                    }
-                }
+            ZF_LOGD("%d %s %d\n",
+                    sender_prio, sender_first ? "->" : "<-", IPC_PAIR_WAITER_PRIO);
+
+            set_helper_priority(env, thread_a, sender_prio);
+            set_helper_priority(env, thread_b, IPC_PAIR_WAITER_PRIO);
+
+            set_helper_affinity(env, thread_a, core_a);
+            set_helper_affinity(env, thread_b, core_b);
+
+            /* Set the flag for nbwait_func that tells it whether or not it really
+             * should wait. */
+            int nbwait_should_wait;
+            nbwait_should_wait =
+                (sender_prio < IPC_PAIR_WAITER_PRIO);
+
+            /* Threads are enqueued at the head of the scheduling queue, so the
+             * thread enqueued last will be run first, for a given priority. */
+            if (sender_first) {
+                start_helper(env, thread_b, (helper_fn_t) fb, thread_b_arg0, start_number,
+                             thread_b_reply, nbwait_should_wait);
+                start_helper(env, thread_a, (helper_fn_t) fa, thread_a_arg0, start_number,
+                             thread_a_reply, nbwait_should_wait);
+            } else {
+                start_helper(env, thread_a, (helper_fn_t) fa, thread_a_arg0, start_number,
+                             thread_a_reply, nbwait_should_wait);
+                start_helper(env, thread_b, (helper_fn_t) fb, thread_b_arg0, start_number,
+                             thread_b_reply, nbwait_should_wait);
             }
+
+            test_result_t res = wait_for_helper(thread_a);
+            test_eq(res, SUCCESS);
+            res = wait_for_helper(thread_b);
+            test_eq(res, SUCCESS);
+
+            reset_helper_pool(helpers, ARRAY_SIZE(helpers));
+
+            start_number += 0x71717171;
         }
     }
 
+    cleanup_helper_pool(env, helpers, ARRAY_SIZE(helpers));
+
     error = cnode_delete(env, ep);
     test_error_eq(error, seL4_NoError);
     return sel4test_get_result();
 }
 
-static int test_send_wait(env_t env)
+static int test_send_wait(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, send_func, wait_func, false, env->cores);
+    return test_ipc_pair(env, send_func, wait_func, false, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0001, "Test SMP seL4_Send + seL4_Recv", test_send_wait, true)
+DEFINE_TEST_PARAM(IPC0001, "Test SMP seL4_Send + seL4_Recv", test_send_wait, IPC_PAIR_PARAMS, true)
 
 static int
-test_call_replywait(env_t env)
+test_call_replywait(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, call_func, replywait_func, false, env->cores);
+    return test_ipc_pair(env, call_func, replywait_func, false, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0002, "Test SMP seL4_Call + seL4_ReplyRecv", test_call_replywait, true)
+DEFINE_TEST_PARAM(IPC0002, "Test SMP seL4_Call + seL4_ReplyRecv", test_call_replywait, IPC_PAIR_PARAMS, true)
 
 static int
-test_call_reply_and_wait(env_t env)
+test_call_reply_and_wait(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, call_func, reply_and_wait_func, false, env->cores);
+    return test_ipc_pair(env, call_func, reply_and_wait_func, false, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0003, "Test SMP seL4_Send + seL4_Reply + seL4_Recv", test_call_reply_and_wait, true)
+DEFINE_TEST_PARAM(IPC0003, "Test SMP seL4_Send + seL4_Reply + seL4_Recv", test_call_reply_and_wait, IPC_PAIR_PARAMS,
+                  true)
 
 static int
-test_nbsend_wait(env_t env)
+test_nbsend_wait(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, nbsend_func, nbwait_func, false, 1);
+    return test_ipc_pair(env, nbsend_func, nbwait_func, false, 1, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0004, "Test seL4_NBSend + seL4_Recv", test_nbsend_wait, true)
+DEFINE_TEST_PARAM(IPC0004, "Test seL4_NBSend + seL4_Recv", test_nbsend_wait, IPC_PAIR_PARAMS, true)
 
 static int
-test_send_wait_interas(env_t env)
+test_send_wait_interas(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, send_func, wait_func, true, env->cores);
+    return test_ipc_pair(env, send_func, wait_func, true, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC1001, "Test SMP inter-AS seL4_Send + seL4_Recv", test_send_wait_interas, true)
+DEFINE_TEST_PARAM(IPC1001, "Test SMP inter-AS seL4_Send + seL4_Recv", test_send_wait_interas, IPC_PAIR_PARAMS, true)
 
 static int
-test_call_replywait_interas(env_t env)
+test_call_replywait_interas(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, call_func, replywait_func, true, env->cores);
+    return test_ipc_pair(env, call_func, replywait_func, true, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC1002, "Test SMP inter-AS seL4_Call + seL4_ReplyRecv", test_call_replywait_interas, true)
+DEFINE_TEST_PARAM(IPC1002, "Test SMP inter-AS seL4_Call + seL4_ReplyRecv", test_call_replywait_interas,
+                  IPC_PAIR_PARAMS, true)
 
 static int
-test_call_reply_and_wait_interas(env_t env)
+test_call_reply_and_wait_interas(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, call_func, reply_and_wait_func, true, env->cores);
+    return test_ipc_pair(env, call_func, reply_and_wait_func, true, env->cores, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC1003, "Test SMP inter-AS seL4_Send + seL4_Reply + seL4_Recv", test_call_reply_and_wait_interas, true)
+DEFINE_TEST_PARAM(IPC1003, "Test SMP inter-AS seL4_Send + seL4_Reply + seL4_Recv", test_call_reply_and_wait_interas,
+                  IPC_PAIR_PARAMS, true)
 
 static int
-test_nbsend_wait_interas(env_t env)
+test_nbsend_wait_interas(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, nbsend_func, nbwait_func, true, 1);
+    return test_ipc_pair(env, nbsend_func, nbwait_func, true, 1, sender_prio, sender_first);
 }
-DEFINE_TEST(IPC1004, "Test inter-AS seL4_NBSend + seL4_Recv", test_nbsend_wait_interas, true)
+DEFINE_TEST_PARAM(IPC1004, "Test inter-AS seL4_NBSend + seL4_Recv", test_nbsend_wait_interas, IPC_PAIR_PARAMS, true)
 
 static int
 test_ipc_abort_in_call(env_t env)
@@ -1234,18 +1241,21 @@ static int test_delete_reply_cap_then_sc(env_t env)
 DEFINE_TEST(IPC0024, "Test deleting the reply cap in the scheduling context",
             test_delete_reply_cap_then_sc, config_set(CONFIG_KERNEL_MCS));
 
-static int test_nbsendrecv(env_t env)
+static int test_nbsendrecv(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, (test_func_t) nbsendrecv_func, (test_func_t) nbsendrecv_func, false, env->cores);
+    return test_ipc_pair(env, (test_func_t) nbsendrecv_func, (test_func_t) nbsendrecv_func, false, env->cores,
+                         sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0025, "Test seL4_nbsendrecv + seL4_nbsendrecv", test_nbsendrecv, config_set(CONFIG_KERNEL_MCS))
+DEFINE_TEST_PARAM(IPC0025, "Test seL4_nbsendrecv + seL4_nbsendrecv", test_nbsendrecv, IPC_PAIR_PARAMS,
+                  config_set(CONFIG_KERNEL_MCS))
 
-static int test_nbsendrecv_interas(env_t env)
+static int test_nbsendrecv_interas(env_t env, int sender_prio, bool sender_first)
 {
-    return test_ipc_pair(env, (test_func_t) nbsendrecv_func, (test_func_t) nbsendrecv_func, false, env->cores);
+    return test_ipc_pair(env, (test_func_t) nbsendrecv_func, (test_func_t) nbsendrecv_func, false, env->cores,
+                         sender_prio, sender_first);
 }
-DEFINE_TEST(IPC0026, "Test interas seL4_nbsendrecv + seL4_nbsendrecv", test_nbsendrecv_interas,
-            config_set(CONFIG_KERNEL_MCS))
+DEFINE_TEST_PARAM(IPC0026, "Test interas seL4_nbsendrecv + seL4_nbsendrecv", test_nbsendrecv_interas, IPC_PAIR_PARAMS,
+                  config_set(CONFIG_KERNEL_MCS))
 
 static int
 test_sched_donation_low_prio_server(env_t env)
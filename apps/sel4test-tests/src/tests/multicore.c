@@ -13,6 +13,7 @@
 #include <sel4/sel4.h>
 
 #include "../helpers.h"
+#include "../perf.h"
 
 static int counter_func(volatile seL4_Word *counter)
 {
@@ -196,46 +197,43 @@ static int handler_func(seL4_CPtr fault_ep, volatile seL4_Word *pf)
     return 0;
 }
 
-static int smp_test_tlb_instance(env_t env, bool inter_as)
+/* handler is a helper thread and faulter a helper process if inter_as is set, or a
+ * helper thread if not. Both are reset, rather than cleaned up, when done. */
+static int smp_test_tlb_instance(env_t env, bool inter_as, helper_thread_t *handler,
+                                 helper_thread_t *faulter)
 {
     int error;
     volatile seL4_Word tag;
     volatile seL4_Word shared_mem = 0;
     ZF_LOGD("smp_test_tlb\n");
 
-    helper_thread_t handler_thread;
-    helper_thread_t faulter_thread;
     vspace_t *vspace;
     seL4_CPtr faulter_vspace, faulter_cspace;
     seL4_CPtr fault_ep = vka_alloc_endpoint_leaky(&env->vka);
-    create_helper_thread(env, &handler_thread);
-    set_helper_priority(env, &handler_thread, 100);
+    set_helper_priority(env, handler, 100);
 
     seL4_CPtr fault_ep_faulter = fault_ep;
     if (inter_as) {
-        create_helper_process(env, &faulter_thread);
-
         /* copy the fault endpoint to the faulter */
         cspacepath_t path;
         vka_cspace_make_path(&env->vka,  fault_ep, &path);
-        seL4_CPtr remote_fault_ep = sel4utils_copy_path_to_process(&faulter_thread.process, path);
+        seL4_CPtr remote_fault_ep = sel4utils_copy_path_to_process(&faulter->process, path);
         assert(remote_fault_ep != -1);
 
         if (!config_set(CONFIG_KERNEL_MCS)) {
             fault_ep_faulter = remote_fault_ep;
         }
 
-        faulter_cspace = faulter_thread.process.cspace.cptr;
-        faulter_vspace = faulter_thread.process.pd.cptr;
-        vspace = &faulter_thread.process.vspace;
+        faulter_cspace = faulter->process.cspace.cptr;
+        faulter_vspace = faulter->process.pd.cptr;
+        vspace = &faulter->process.vspace;
     } else {
-        create_helper_thread(env, &faulter_thread);
         faulter_cspace = env->cspace_root;
         faulter_vspace = env->page_directory;
         vspace = &env->vspace;
     }
 
-    error = api_tcb_set_space(get_helper_tcb(&faulter_thread),
+    error = api_tcb_set_space(get_helper_tcb(faulter),
                               fault_ep_faulter,
                               faulter_cspace,
                               api_make_guard_skip_word(seL4_WordBits - env->cspace_size_bits),
@@ -243,14 +241,14 @@ static int smp_test_tlb_instance(env_t env, bool inter_as)
     test_error_eq(error, seL4_NoError);
 
     /* Move handler to core 1 and faulter to the last available core */
-    set_helper_affinity(env, &handler_thread, 1);
-    set_helper_affinity(env, &faulter_thread, env->cores - 1);
+    set_helper_affinity(env, handler, 1);
+    set_helper_affinity(env, faulter, env->cores - 1);
 
     /* Map new page to shared address space */
     shared_mem = (seL4_Word) vspace_new_pages(vspace, seL4_AllRights, 1, seL4_PageBits);
 
-    start_helper(env, &handler_thread, (helper_fn_t) handler_func, fault_ep, (seL4_Word) &tag, 0, 0);
-    start_helper(env, &faulter_thread, (helper_fn_t) faulter_func, (seL4_Word) shared_mem, 0, 0, 0);
+    start_helper(env, handler, (helper_fn_t) handler_func, fault_ep, (seL4_Word) &tag, 0, 0);
+    start_helper(env, faulter, (helper_fn_t) faulter_func, (seL4_Word) shared_mem, 0, 0, 0);
 
     /* Wait for some access... */
     sel4test_sleep(env, 10 * NS_IN_MS);
@@ -265,27 +263,46 @@ static int smp_test_tlb_instance(env_t env, bool inter_as)
     test_check(tag == seL4_Fault_VMFault);
 
     /* Done. */
-    cleanup_helper(env, &faulter_thread);
-    cleanup_helper(env, &handler_thread);
+    reset_helper(faulter);
+    reset_helper(handler);
     return sel4test_get_result();
 }
 
-int smp_test_tlb(env_t env)
+/* Unmapping a frame from the same VSpace and from a different VSpace */
+#define TLB_PARAMS(P, t) P(t, SAME_AS, false) P(t, INTER_AS, true)
+#define TLB_ITERATIONS 10
+
+int smp_test_tlb(env_t env, bool inter_as)
 {
     test_result_t result;
-    /* Test unmapping a frame from the same VSpace and different VSpace. */
-    for (int i = 0; i < 20; i++) {
-        bool inter_as = (i % 2 == 0) ? true : false;
-        result = smp_test_tlb_instance(env, inter_as);
+    helper_thread_t handler_thread, faulter;
+
+    /* the same helpers are used by every iteration */
+    create_helper_thread(env, &handler_thread);
+    if (inter_as) {
+        create_helper_process(env, &faulter);
+    } else {
+        create_helper_thread(env, &faulter);
+    }
+
+    for (int i = 0; i < TLB_ITERATIONS; i++) {
+        result = smp_test_tlb_instance(env, inter_as, &handler_thread, &faulter);
         if (result != SUCCESS) {
-            return result;
+            break;
         }
     }
+
+    cleanup_helper(env, &faulter);
+    cleanup_helper(env, &handler_thread);
     return result;
 
 }
-DEFINE_TEST(MULTICORE0003, "Test TLB invalidated cross cores", smp_test_tlb,
-            config_set(CONFIG_HAVE_TIMER) &&CONFIG_MAX_NUM_NODES > 1)
+DEFINE_TEST_PARAM(MULTICORE0003, "Test TLB invalidated cross cores", smp_test_tlb, TLB_PARAMS,
+                  config_set(CONFIG_HAVE_TIMER) &&CONFIG_MAX_NUM_NODES > 1)
+/* each iteration sleeps for 10 ms and a tenth of a tick, on top of the 10 ms of a
+ * usual test. The sleeps and the budget are both divided by CONFIG_SEL4TEST_TIME_SCALE. */
+DEFINE_TEST_BUDGET(MULTICORE0003, TLB_ITERATIONS * (10 + CONFIG_TIMER_TICK_MS / 10) + 10,
+                   TEST_BUDGET_SCALED)
 
 static int
 kernel_entry_func(seL4_Word *unused)
@@ -337,3 +354,176 @@ int smp_test_tcb_clh(env_t env)
 }
 DEFINE_TEST(MULTICORE0004, "Test core stalling is behaving properly (flaky)", smp_test_tcb_clh,
             CONFIG_MAX_NUM_NODES > 1)
+
+/* Number of unmaps timed for each configuration of MULTICORE_PERF0001 */
+#define TLB_PERF_ITERATIONS 50
+
+/* State shared between the thread doing the unmaps and the threads keeping
+ * the address space active on the other cores */
+typedef struct tlb_perf_ctrl {
+    /* bumped for each new page to touch */
+    volatile seL4_Word generation;
+    /* vaddr of the page to touch, valid in the address space being measured */
+    volatile seL4_Word target;
+    /* last generation each toucher has pulled into its TLB */
+    volatile seL4_Word ack[CONFIG_MAX_NUM_NODES];
+} tlb_perf_ctrl_t;
+
+static int tlb_perf_toucher(seL4_Word ctrl_vaddr, seL4_Word id)
+{
+    volatile tlb_perf_ctrl_t *ctrl = (volatile tlb_perf_ctrl_t *) ctrl_vaddr;
+    seL4_Word seen = 0;
+
+    /* Keep spinning in the address space so that it stays active on this core,
+     * and only touch the target once so that we do not fault after the unmap */
+    while (1) {
+        seL4_Word generation = ctrl->generation;
+        if (generation != seen) {
+            THREAD_MEMORY_FENCE();
+            (void) *(volatile seL4_Word *) ctrl->target;
+            seen = generation;
+            ctrl->ack[id] = generation;
+        }
+    }
+
+    return 0;
+}
+
+/* Create and start a toucher thread inside another process' address space. This
+ * does not go through start_helper, as that would run a second thread on the
+ * process' only TLS region. The toucher never uses TLS or makes a syscall. */
+static void tlb_perf_start_remote_toucher(env_t env, sel4utils_process_t *process, helper_thread_t *toucher,
+                                          seL4_Word ctrl_vaddr, seL4_Word id)
+{
+    seL4_Word data = api_make_guard_skip_word(seL4_WordBits - TEST_PROCESS_CSPACE_SIZE_BITS);
+    sel4utils_thread_config_t config = thread_config_default(&env->simple, process->cspace.cptr, data,
+                                                             seL4_CapNull, OUR_PRIO - 1);
+    int error = sel4utils_configure_thread_config(&env->vka, &env->vspace, &process->vspace, config,
+                                                  &toucher->thread);
+    ZF_LOGF_IF(error, "Failed to configure remote toucher");
+    toucher->is_process = false;
+
+    set_helper_affinity(env, toucher, id + 1);
+
+    seL4_UserContext context = {0};
+    uintptr_t stack_pointer = ALIGN_DOWN((uintptr_t) toucher->thread.stack_top, STACK_CALL_ALIGNMENT);
+    error = sel4utils_arch_init_context_with_args((sel4utils_thread_entry_fn) tlb_perf_toucher,
+                                                  (void *) ctrl_vaddr, (void *) id, NULL, false,
+                                                  (void *) stack_pointer, &context, &env->vka,
+                                                  &env->vspace, &process->vspace);
+    ZF_LOGF_IF(error, "Failed to initialise remote toucher context");
+    error = seL4_TCB_WriteRegisters(toucher->thread.tcb.cptr, 1, 0, sizeof(seL4_UserContext) / sizeof(seL4_Word),
+                                    &context);
+    ZF_LOGF_IF(error, "Failed to start remote toucher");
+}
+
+/*
+ * Time seL4_ARCH_Page_Unmap of a page that is in the TLB of num_touchers other
+ * cores, each of which is actively running in the address space the page is
+ * mapped into. If inter_as is set that address space belongs to a helper process,
+ * otherwise it is our own (so our core is also using it).
+ */
+static int perf_tlb_shootdown_instance(env_t env, bool inter_as, int num_touchers, uint64_t overhead)
+{
+    int error;
+    helper_thread_t touchers[CONFIG_MAX_NUM_NODES];
+    helper_thread_t process;
+    vspace_t *vspace;
+    tlb_perf_ctrl_t local_ctrl = {0};
+    volatile tlb_perf_ctrl_t *ctrl;
+    seL4_Word ctrl_vaddr;
+
+    if (inter_as) {
+        create_helper_process(env, &process);
+        vspace = &process.process.vspace;
+        ctrl = (volatile tlb_perf_ctrl_t *) vspace_new_pages(&env->vspace, seL4_AllRights, 1, seL4_PageBits);
+        test_assert(ctrl != NULL);
+        ctrl_vaddr = (seL4_Word) vspace_share_mem(&env->vspace, vspace, (void *) ctrl, 1, seL4_PageBits,
+                                                  seL4_AllRights, 1);
+        test_assert(ctrl_vaddr != 0);
+    } else {
+        vspace = &env->vspace;
+        ctrl = &local_ctrl;
+        ctrl_vaddr = (seL4_Word) ctrl;
+    }
+
+    for (int i = 0; i < num_touchers; i++) {
+        if (inter_as) {
+            tlb_perf_start_remote_toucher(env, &process.process, &touchers[i], ctrl_vaddr, i);
+        } else {
+            create_helper_thread(env, &touchers[i]);
+            set_helper_affinity(env, &touchers[i], i + 1);
+            start_helper(env, &touchers[i], (helper_fn_t) tlb_perf_toucher, ctrl_vaddr, i, 0, 0);
+        }
+    }
+
+    perf_stats_t stats;
+    perf_stats_init(&stats);
+    for (seL4_Word generation = 1; generation <= TLB_PERF_ITERATIONS; generation++) {
+        void *target = vspace_new_pages(vspace, seL4_AllRights, 1, seL4_PageBits);
+        test_assert(target != NULL);
+        seL4_CPtr frame = vspace_get_cap(vspace, target);
+
+        ctrl->target = (seL4_Word) target;
+        THREAD_MEMORY_FENCE();
+        ctrl->generation = generation;
+
+        /* wait for every toucher to have the page in its TLB */
+        for (int i = 0; i < num_touchers; i++) {
+            while (ctrl->ack[i] != generation);
+        }
+
+        uint64_t start = sel4test_timestamp(env);
+        error = seL4_ARCH_Page_Unmap(frame);
+        uint64_t end = sel4test_timestamp(env);
+        test_error_eq(error, seL4_NoError);
+        perf_stats_add(&stats, perf_sample(start, end, overhead));
+
+        /* the frame is already unmapped, this just returns it */
+        vspace_unmap_pages(vspace, target, 1, seL4_PageBits, VSPACE_FREE);
+    }
+
+    perf_stats_print("MULTICORE_PERF0001", inter_as ? "inter_as" : "same_vspace",
+                     num_touchers + (inter_as ? 0 : 1), &stats);
+
+    for (int i = 0; i < num_touchers; i++) {
+        if (inter_as) {
+            seL4_TCB_Suspend(touchers[i].thread.tcb.cptr);
+            sel4utils_clean_up_thread(&env->vka, vspace, &touchers[i].thread);
+        } else {
+            cleanup_helper(env, &touchers[i]);
+        }
+    }
+    if (inter_as) {
+        cleanup_helper(env, &process);
+        vspace_unmap_pages(&env->vspace, (void *) ctrl, 1, seL4_PageBits, VSPACE_FREE);
+    }
+
+    return sel4test_get_result();
+}
+
+int perf_tlb_shootdown(env_t env)
+{
+    uint64_t overhead = perf_timestamp_overhead(env);
+    perf_print("MULTICORE_PERF0001", "timestamp", 0, "overhead", overhead);
+
+    /* The parameter printed is the number of cores the address space is active
+     * on. When unmapping from our own vspace that includes our core, so it goes
+     * from 1 to env->cores. When unmapping from another address space it goes
+     * from 0 to env->cores - 1, as our core is not running in it. */
+    for (int inter_as = 0; inter_as < 2; inter_as++) {
+        for (int num_touchers = 0; num_touchers < env->cores; num_touchers++) {
+            int result = perf_tlb_shootdown_instance(env, inter_as, num_touchers, overhead);
+            if (result != SUCCESS) {
+                return result;
+            }
+        }
+    }
+
+    return sel4test_get_result();
+}
+DEFINE_TEST(MULTICORE_PERF0001, "Measure cross core TLB shootdown cost of unmapping a page", perf_tlb_shootdown,
+            config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER) &&CONFIG_MAX_NUM_NODES > 1)
+/* mostly creating the toucher threads and helper process of each of the
+ * 2 * CONFIG_MAX_NUM_NODES configurations */
+DEFINE_TEST_BUDGET(MULTICORE_PERF0001, CONFIG_MAX_NUM_NODES * 100, TEST_BUDGET_FIXED)
@@ -13,6 +13,7 @@
 #include <vka/object.h>
 
 #include "../helpers.h"
+#include "../perf.h"
 
 #define PRIORITY_FUDGE 1
 
@@ -1037,6 +1038,201 @@ int test_scheduler_accuracy(env_t env)
 DEFINE_TEST(SCHED0011, "Test scheduler accuracy",
             test_scheduler_accuracy, config_set(CONFIG_KERNEL_MCS) &&config_set(CONFIG_HAVE_TIMER))
 
+/* Number of jobs (periods) recorded for each thread by SCHED_PERF0001 */
+#define SCHED_PERF_PERIODS 20
+/* How often a thread checks the time during its budget. More checks give a
+ * tighter bound on the exhaustion time, but each is an RPC to the driver that
+ * shows up as extra wall clock time in the job. */
+#define SCHED_PERF_CHECKS_PER_BUDGET 20
+#define SCHED_PERF_MAX_THREADS 4
+/* spins timed to work out how many spins make up a check interval */
+#define SCHED_PERF_CALIBRATION_SPINS 100000
+
+/* budget and period in microseconds, as for set_helper_sched_params */
+typedef struct sched_perf_task {
+    uint64_t budget;
+    uint64_t period;
+} sched_perf_task_t;
+
+/* Task sets measured by SCHED_PERF0001. Every thread of a set runs on core 0 at
+ * the same priority, so each runs until its budget is exhausted before the next
+ * one gets the core. Edit this table to measure other configurations. */
+static const struct {
+    int num_threads;
+    sched_perf_task_t tasks[SCHED_PERF_MAX_THREADS];
+} sched_perf_task_sets[] = {
+    { 1, { { 10 * US_IN_MS, 50 * US_IN_MS } } },
+    { 2, { { 10 * US_IN_MS, 50 * US_IN_MS }, { 20 * US_IN_MS, 100 * US_IN_MS } } },
+    {
+        4, {
+            { 5 * US_IN_MS, 20 * US_IN_MS }, { 10 * US_IN_MS, 50 * US_IN_MS },
+            { 10 * US_IN_MS, 100 * US_IN_MS }, { 20 * US_IN_MS, 200 * US_IN_MS }
+        }
+    },
+};
+
+typedef struct sched_perf_job {
+    /* first time the thread saw after being released */
+    uint64_t release;
+    /* last time the thread saw before running out of budget */
+    uint64_t exhausted;
+} sched_perf_job_t;
+
+typedef struct sched_perf_thread {
+    env_t env;
+    /* spins between time checks */
+    uint64_t chunk_spins;
+    /* a jump in time larger than this means we were descheduled */
+    uint64_t gap;
+    sched_perf_job_t jobs[SCHED_PERF_PERIODS];
+} sched_perf_thread_t;
+
+static void sched_perf_spin(uint64_t spins)
+{
+    for (volatile uint64_t i = 0; i < spins; i++);
+}
+
+static int sched_perf_helper(sched_perf_thread_t *thread)
+{
+    env_t env = thread->env;
+    int job = 0;
+    uint64_t last = sel4test_timestamp(env);
+
+    thread->jobs[0].release = last;
+    while (1) {
+        sched_perf_spin(thread->chunk_spins);
+        uint64_t now = sel4test_timestamp(env);
+        if (now - last > thread->gap) {
+            /* we ran out of budget somewhere between last and now */
+            thread->jobs[job].exhausted = last;
+            job++;
+            if (job == SCHED_PERF_PERIODS) {
+                return 0;
+            }
+            thread->jobs[job].release = now;
+        }
+        last = now;
+    }
+}
+
+static void sched_perf_report(int set, int id, const sched_perf_task_t *task, sched_perf_thread_t *thread)
+{
+    uint64_t budget = task->budget * NS_IN_US;
+    uint64_t period = task->period * NS_IN_US;
+    /* anything within one check interval of the budget is measurement error */
+    uint64_t tolerance = budget / SCHED_PERF_CHECKS_PER_BUDGET;
+    sched_perf_job_t *jobs = thread->jobs;
+    perf_stats_t interval, jitter, consumed, overrun;
+    uint64_t overruns = 0;
+    uint64_t missed = 0;
+    char variant[32];
+
+    perf_stats_init(&interval);
+    perf_stats_init(&jitter);
+    perf_stats_init(&consumed);
+    perf_stats_init(&overrun);
+
+    for (int i = 0; i < SCHED_PERF_PERIODS; i++) {
+        uint64_t used = jobs[i].exhausted - jobs[i].release;
+        perf_stats_add(&consumed, used);
+        perf_stats_add(&overrun, used > budget ? used - budget : 0);
+        if (used > budget + tolerance) {
+            overruns++;
+        }
+        /* implicit deadline at the end of the job's nominal period */
+        if (jobs[i].exhausted > jobs[0].release + (i + 1) * period) {
+            missed++;
+        }
+        if (i > 0) {
+            uint64_t diff = jobs[i].release - jobs[i - 1].release;
+            perf_stats_add(&interval, diff);
+            perf_stats_add(&jitter, diff > period ? diff - period : period - diff);
+        }
+    }
+
+    snprintf(variant, sizeof(variant), "set%d_budget", set);
+    perf_print("SCHED_PERF0001", variant, id, "ns", budget);
+    snprintf(variant, sizeof(variant), "set%d_period", set);
+    perf_print("SCHED_PERF0001", variant, id, "ns", period);
+    snprintf(variant, sizeof(variant), "set%d_release_interval", set);
+    perf_stats_print("SCHED_PERF0001", variant, id, &interval);
+    snprintf(variant, sizeof(variant), "set%d_release_jitter", set);
+    perf_stats_print("SCHED_PERF0001", variant, id, &jitter);
+    snprintf(variant, sizeof(variant), "set%d_consumed", set);
+    perf_stats_print("SCHED_PERF0001", variant, id, &consumed);
+    snprintf(variant, sizeof(variant), "set%d_overrun", set);
+    perf_stats_print("SCHED_PERF0001", variant, id, &overrun);
+    snprintf(variant, sizeof(variant), "set%d_overruns", set);
+    perf_print("SCHED_PERF0001", variant, id, "count", overruns);
+    snprintf(variant, sizeof(variant), "set%d_missed_deadlines", set);
+    perf_print("SCHED_PERF0001", variant, id, "count", missed);
+}
+
+int test_scheduler_jitter(env_t env)
+{
+    /*
+     * Run each task set of periodic threads that burn their whole budget, and
+     * record when each job was released and when it ran out of budget, as seen
+     * by the thread itself.
+     */
+    int error;
+
+    /* work out the speed of a spin while nothing else is running */
+    uint64_t start = sel4test_timestamp(env);
+    sched_perf_spin(SCHED_PERF_CALIBRATION_SPINS);
+    uint64_t spin_ns = MAX(sel4test_timestamp(env) - start, 1);
+
+    /* set priority down so we can run the helper(s) at a higher prio */
+    error = seL4_TCB_SetPriority(env->tcb, env->tcb, env->priority - 1);
+    test_eq(error, seL4_NoError);
+
+    /* every task set runs on the same helpers */
+    helper_thread_t helpers[SCHED_PERF_MAX_THREADS];
+    create_helper_pool(env, helpers, ARRAY_SIZE(helpers), false);
+    for (int i = 0; i < ARRAY_SIZE(helpers); i++) {
+        set_helper_priority(env, &helpers[i], env->priority);
+    }
+
+    for (int set = 0; set < ARRAY_SIZE(sched_perf_task_sets); set++) {
+        int num_threads = sched_perf_task_sets[set].num_threads;
+        const sched_perf_task_t *tasks = sched_perf_task_sets[set].tasks;
+        sched_perf_thread_t threads[num_threads];
+
+        for (int i = 0; i < num_threads; i++) {
+            uint64_t check_ns = tasks[i].budget * NS_IN_US / SCHED_PERF_CHECKS_PER_BUDGET;
+            threads[i].env = env;
+            threads[i].chunk_spins = MAX(SCHED_PERF_CALIBRATION_SPINS * check_ns / spin_ns, 1);
+            threads[i].gap = (tasks[i].period - tasks[i].budget) * NS_IN_US / 2;
+            test_gt(threads[i].gap, check_ns);
+
+            error = set_helper_sched_params(env, &helpers[i], tasks[i].budget, tasks[i].period, 0);
+            test_eq(error, seL4_NoError);
+        }
+
+        for (int i = 0; i < num_threads; i++) {
+            start_helper(env, &helpers[i], (helper_fn_t) sched_perf_helper, (seL4_Word) &threads[i], 0, 0, 0);
+        }
+
+        for (int i = 0; i < num_threads; i++) {
+            wait_for_helper(&helpers[i]);
+        }
+
+        for (int i = 0; i < num_threads; i++) {
+            sched_perf_report(set, i, &tasks[i], &threads[i]);
+        }
+        reset_helper_pool(helpers, num_threads);
+    }
+
+    cleanup_helper_pool(env, helpers, ARRAY_SIZE(helpers));
+
+    return sel4test_get_result();
+}
+DEFINE_TEST(SCHED_PERF0001, "Measure release jitter, overruns and missed deadlines of periodic threads",
+            test_scheduler_jitter,
+            config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_KERNEL_MCS) &&config_set(CONFIG_HAVE_TIMER))
+/* SCHED_PERF_PERIODS of the longest period of each task set, 50, 100 and 200 ms */
+DEFINE_TEST_BUDGET(SCHED_PERF0001, SCHED_PERF_PERIODS * (50 + 100 + 200) + 1000, TEST_BUDGET_FIXED)
+
 /* used by sched0012, 0013, 0014 */
 static void
 periodic_thread(int id, volatile unsigned long *counters)
@@ -1063,7 +1259,7 @@ int test_one_periodic_thread(env_t env)
 
     create_helper_thread(env, &helper);
     set_helper_priority(env, &helper, env->priority);
-    error = set_helper_sched_params(env, &helper, 0.2 * US_IN_S, US_IN_S, 0);
+    error = set_helper_sched_params(env, &helper, scale_duration(0.2 * US_IN_S), scale_duration(US_IN_S), 0);
     test_eq(error, seL4_NoError);
 
     start_helper(env, &helper, (helper_fn_t) periodic_thread, 0, (seL4_Word) &counter, 0, 0);
@@ -1077,6 +1273,8 @@ int test_one_periodic_thread(env_t env)
 }
 DEFINE_TEST(SCHED0012, "Test one periodic thread", test_one_periodic_thread,
             config_set(CONFIG_KERNEL_MCS) &&config_set(CONFIG_HAVE_TIMER))
+/* 10 periods of 1 s */
+DEFINE_TEST_BUDGET(SCHED0012, 10000, TEST_BUDGET_SCALED)
 
 int
 test_two_periodic_threads(env_t env)
@@ -1094,8 +1292,8 @@ test_two_periodic_threads(env_t env)
         set_helper_priority(env, &helpers[i], env->priority);
     }
 
-    set_helper_sched_params(env, &helpers[0], 0.1 * US_IN_S, 2 * US_IN_S, 0);
-    set_helper_sched_params(env, &helpers[1], 0.1 * US_IN_S, 3 * US_IN_S, 0);
+    set_helper_sched_params(env, &helpers[0], scale_duration(0.1 * US_IN_S), scale_duration(2 * US_IN_S), 0);
+    set_helper_sched_params(env, &helpers[1], scale_duration(0.1 * US_IN_S), scale_duration(3 * US_IN_S), 0);
 
     for (int i = 0; i < num_threads; i++) {
         start_helper(env, &helpers[i], (helper_fn_t) periodic_thread, i, (seL4_Word) counters, 0, 0);
@@ -1109,6 +1307,8 @@ test_two_periodic_threads(env_t env)
 }
 DEFINE_TEST(SCHED0013, "Test two periodic threads", test_two_periodic_threads,
             config_set(CONFIG_KERNEL_MCS) &&config_set(CONFIG_HAVE_TIMER));
+/* 3 periods of 2 s */
+DEFINE_TEST_BUDGET(SCHED0013, 6000, TEST_BUDGET_SCALED)
 
 int test_ordering_periodic_threads(env_t env)
 {
@@ -1134,9 +1334,9 @@ int test_ordering_periodic_threads(env_t env)
         set_helper_priority(env, &helpers[i], env->priority);
     }
 
-    set_helper_sched_params(env, &helpers[0], 20 * US_IN_MS, 100 * US_IN_MS, 0);
-    set_helper_sched_params(env, &helpers[1], 20 * US_IN_MS, 200 * US_IN_MS, 0);
-    set_helper_sched_params(env, &helpers[2], 20 * US_IN_MS, 800 * US_IN_MS, 0);
+    set_helper_sched_params(env, &helpers[0], scale_duration(20 * US_IN_MS), scale_duration(100 * US_IN_MS), 0);
+    set_helper_sched_params(env, &helpers[1], scale_duration(20 * US_IN_MS), scale_duration(200 * US_IN_MS), 0);
+    set_helper_sched_params(env, &helpers[2], scale_duration(20 * US_IN_MS), scale_duration(800 * US_IN_MS), 0);
 
     for (int i = 0; i < num_threads; i++) {
         start_helper(env, &helpers[i], (helper_fn_t) periodic_thread, i, (seL4_Word) counters, 0, 0);
@@ -1159,6 +1359,8 @@ int test_ordering_periodic_threads(env_t env)
 }
 DEFINE_TEST(SCHED0014, "Test periodic thread ordering", test_ordering_periodic_threads,
             config_set(CONFIG_KERNEL_MCS) &&config_set(CONFIG_HAVE_TIMER))
+/* 11 periods of 800 ms */
+DEFINE_TEST_BUDGET(SCHED0014, 9000, TEST_BUDGET_SCALED)
 
 static void
 sched0015_helper(int id, env_t env, volatile unsigned long long *counters)
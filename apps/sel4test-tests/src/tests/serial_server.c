@@ -3,6 +3,8 @@
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -17,13 +19,19 @@
 
 #include "../test.h"
 #include "../helpers.h"
+#include "../perf.h"
+#include "../serial_batch.h"
 
 #define SERSERV_TEST_PRIO_SERVER    (seL4_MaxPrio - 1)
 #define SERSERV_TEST_PRIO_CLIENT    (seL4_MinPrio)
 
 #define SERSERV_TEST_N_CLIENTS      (1)
+/* Upper bound on the number of clients a single test can start. SERSERV_PERF0001
+ * doubles its clients from 1 up to this. */
+#define SERSERV_TEST_MAX_CLIENTS    MAX(SERSERV_TEST_N_CLIENTS, CONFIG_SEL4TEST_SERSERV_PERF_CLIENTS)
 
 #define SERSERV_TEST_ALLOCMAN_PREALLOCATED_MEMSIZE (64 * 1024)
+#define SERSERV_TEST_ALLOCMAN_PAGES BYTES_TO_4K_PAGES(SERSERV_TEST_ALLOCMAN_PREALLOCATED_MEMSIZE)
 #define SERSERV_TEST_UT_SIZE        (512 * 1024)
 
 static const char *test_str = "Hello, world!\n";
@@ -54,6 +62,11 @@ typedef struct _client_test_data {
     volatile void **parent_used_pages_list, *client_used_pages_list;
     int n_used_pages;
     cspacepath_t badged_server_ep_cspath, badged_server_ep_cspath2, ut_512k_cspath;
+    /* Initial memory for the allocman_t of a client process, shared with it by
+     * the parent, at its address in each VSpace. */
+    void *parent_allocman_mem, *client_allocman_mem;
+    /* Set if the parent already connected "conn" on behalf of a client thread */
+    bool preconnected;
     serial_client_context_t conn;
 } client_test_data_t;
 
@@ -63,8 +76,8 @@ struct {
     vka_t *vka;
     vspace_t *vspace;
     simple_t *simple;
-    client_test_data_t client_test_data[SERSERV_TEST_N_CLIENTS];
-    uint8_t allocman_mem[SERSERV_TEST_N_CLIENTS][SERSERV_TEST_ALLOCMAN_PREALLOCATED_MEMSIZE];
+    int n_clients;
+    client_test_data_t client_test_data[SERSERV_TEST_MAX_CLIENTS];
 } static client_globals;
 
 /* These next few functions (client_*_main())are the actual tests that are run
@@ -192,13 +205,83 @@ static int client_disconnect_main(client_test_data_t *self, vka_t *vka, vspace_t
     return 0;
 }
 
-static void init_file_globals(struct env *env)
+/* Writes made by each client in SERSERV_PERF0001 */
+#define SERSERV_PERF_N_WRITES       (128)
+
+static const char *perf_str = "serserv perf 0\n";
+
+static int client_perf_connect(client_test_data_t *self, vka_t *vka, vspace_t *vspace)
+{
+    if (self->preconnected) {
+        return 0;
+    }
+    return serial_server_client_connect(self->badged_server_ep_cspath.capPtr,
+                                        vka, vspace,
+                                        &self->conn);
+}
+
+/** This function will guide a client to connect to the server, if the parent
+ * hasn't already, make SERSERV_PERF_N_WRITES write() requests and disconnect.
+ */
+static int client_throughput_main(client_test_data_t *self, vka_t *vka, vspace_t *vspace)
+{
+    int error;
+    size_t len = strlen(perf_str);
+
+    error = client_perf_connect(self, vka, vspace);
+    if (error != 0) {
+        return error;
+    }
+
+    for (int i = 0; i < SERSERV_PERF_N_WRITES; i++) {
+        error = serial_server_write(&self->conn, perf_str, len);
+        if (error != len) {
+            return -1;
+        }
+    }
+
+    serial_server_disconnect(&self->conn);
+    return 0;
+}
+
+/** Same as client_throughput_main(), but the writes are gathered through a
+ * serial_batch_t. SERSERV_PERF0001 reports these as the *_batch_model variants.
+ */
+static int client_batched_throughput_main(client_test_data_t *self, vka_t *vka, vspace_t *vspace)
+{
+    int error;
+    serial_batch_t batch;
+    size_t len = strlen(perf_str);
+
+    error = client_perf_connect(self, vka, vspace);
+    if (error != 0) {
+        return error;
+    }
+
+    serial_batch_init(&batch, &self->conn);
+    for (int i = 0; i < SERSERV_PERF_N_WRITES; i++) {
+        error = serial_batch_write(&batch, perf_str, len);
+        if (error != 0) {
+            return error;
+        }
+    }
+    error = serial_batch_flush(&batch);
+    if (error != 0) {
+        return error;
+    }
+
+    serial_server_disconnect(&self->conn);
+    return 0;
+}
+
+static void init_file_globals(struct env *env, int n_clients)
 {
+    assert(n_clients > 0 && n_clients <= SERSERV_TEST_MAX_CLIENTS);
+    client_globals.n_clients = n_clients;
+
     memset(client_globals.client_test_data, 0,
            sizeof(client_globals.client_test_data));
 
-    memset(client_globals.allocman_mem, 0, sizeof(client_globals.allocman_mem));
-
     client_globals.vka = &env->vka;
     client_globals.vspace = &env->vspace;
     client_globals.simple = &env->simple;
@@ -208,7 +291,7 @@ static int mint_server_ep_to_clients(struct env *env, bool mint_2nd_ep)
 {
     int error;
 
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         /* Ask the serserv library to mint the Server's EP to all the new clients. */
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
 
@@ -247,7 +330,7 @@ static int mint_server_ep_to_clients(struct env *env, bool mint_2nd_ep)
 
 static void create_clients(struct env *env, bool is_process)
 {
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
 
         if (is_process) {
@@ -368,7 +451,7 @@ static int client_common_entry_point(seL4_Word _test_fn, seL4_Word _used_pages_l
                                                              BYTES_TO_SIZE_BITS(SERSERV_TEST_UT_SIZE),
                                                              client_data->ut_512k_cspath.capPtr + 0x8,
                                                              used_pages_list,
-                                                             client_globals.allocman_mem[thread_num],
+                                                             client_data->client_allocman_mem,
                                                              SERSERV_TEST_ALLOCMAN_PREALLOCATED_MEMSIZE,
                                                              &allocman,
                                                              vka, vspace,
@@ -386,7 +469,7 @@ static void start_clients(struct env *env, client_test_fn *test_fn)
 {
     bool is_process = client_globals.client_test_data[0].thread.is_process;
 
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
         /* The client threads don't need a list of used pages. The client
          * processes do need it -- so if the used pages list is NULL, the newly
@@ -407,9 +490,20 @@ static void start_clients(struct env *env, client_test_fn *test_fn)
 
 static void cleanup_clients(struct env *env)
 {
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
-        helper_thread_t *curr_client = &client_globals.client_test_data[i].thread;
-        cleanup_helper(env, curr_client);
+    for (int i = 0; i < client_globals.n_clients; i++) {
+        client_test_data_t *curr_client = &client_globals.client_test_data[i];
+        cleanup_helper(env, &curr_client->thread);
+
+        /* The pages shared with a client process are only freed by the parent,
+         * once the client is gone. */
+        if (curr_client->parent_allocman_mem != NULL) {
+            vspace_unmap_pages(&env->vspace, curr_client->parent_allocman_mem,
+                               SERSERV_TEST_ALLOCMAN_PAGES, seL4_PageBits, VSPACE_FREE);
+        }
+        if (curr_client->parent_used_pages_list != NULL) {
+            vspace_unmap_pages(&env->vspace, (void *)curr_client->parent_used_pages_list,
+                               1, seL4_PageBits, VSPACE_FREE);
+        }
     }
 }
 
@@ -505,6 +599,40 @@ static int share_sel4utils_used_pages_list(volatile void **page_list, size_t n_e
     return 1;
 }
 
+/** Allocates the initial allocman_t memory of a new client process and shares
+ * it with the process, so that only clients that need it take up memory.
+ *
+ * @param page_list List of used pages of the new process, whose first
+ *                  "n_entries" entries are filled in. The pages shared with
+ *                  the process are added after them.
+ * @param n_entries Number of entries in the page_list.
+ * @param client Client whose allocman memory is set up.
+ * @return Negative integer on failure. Positive integer on success, which
+ *         represents the number of ADDITIONAL used pages filled in by this
+ *         function invocation.
+ */
+static int share_client_allocman_mem(struct env *env, volatile void **page_list, size_t n_entries,
+                                     client_test_data_t *client)
+{
+    client->parent_allocman_mem = vspace_new_pages(&env->vspace, seL4_AllRights,
+                                                   SERSERV_TEST_ALLOCMAN_PAGES, seL4_PageBits);
+    if (client->parent_allocman_mem == NULL) {
+        return -1;
+    }
+    client->client_allocman_mem = vspace_share_mem(&env->vspace, &client->thread.process.vspace,
+                                                   client->parent_allocman_mem,
+                                                   SERSERV_TEST_ALLOCMAN_PAGES, seL4_PageBits,
+                                                   seL4_AllRights, true);
+    if (client->client_allocman_mem == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < SERSERV_TEST_ALLOCMAN_PAGES; i++) {
+        page_list[n_entries + i] = (void *)((uintptr_t)client->client_allocman_mem + i * BIT(seL4_PageBits));
+    }
+    return SERSERV_TEST_ALLOCMAN_PAGES;
+}
+
 /** For each new client process, fill out a list of virtual pages that will be
  * occupied in its VSpace before it even begins executing.
  *
@@ -516,7 +644,7 @@ static int setup_pclient_used_pages_lists(struct env *env)
 {
     int error;
 
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
 
         /* Allocate the page in our VSpace */
@@ -538,6 +666,14 @@ static int setup_pclient_used_pages_lists(struct env *env)
             return -1;
         }
 
+        /* Add the pages of the client's allocman memory */
+        error = share_client_allocman_mem(env, curr_client->parent_used_pages_list,
+                                          curr_client->n_used_pages, curr_client);
+        if (error < 0) {
+            return -1;
+        }
+        curr_client->n_used_pages += error;
+
         /* Share the page containing the used pages list with the new process */
         error = share_sel4utils_used_pages_list(curr_client->parent_used_pages_list,
                                                 curr_client->n_used_pages,
@@ -566,7 +702,7 @@ static int alloc_untypeds_for_clients(struct env *env)
 {
     int error;
 
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
         vka_object_t tmp;
 
@@ -589,7 +725,7 @@ static int alloc_untypeds_for_clients(struct env *env)
 
 static void copy_client_data_to_shmem(struct env *env)
 {
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         client_test_data_t *curr_client = &client_globals.client_test_data[i];
         /* +1 because the list is NULL terminated and we want to get past the
          * end of the list.
@@ -597,21 +733,23 @@ static void copy_client_data_to_shmem(struct env *env)
         void *client_data_copy = &curr_client->parent_used_pages_list[
                               curr_client->n_used_pages + 1];
 
+        test_assert_fatal((uintptr_t)client_data_copy + sizeof(*curr_client)
+                          <= (uintptr_t)curr_client->parent_used_pages_list + BIT(seL4_PageBits));
         memcpy(client_data_copy, curr_client, sizeof(*curr_client));
     }
 }
 
-static int concurrency_test_common(struct env *env, bool is_process, client_test_fn *test_fn, bool mint_2nd_ep_cap)
+/** Creates "n_clients" client threads or processes and mints them the
+ * Server's endpoint, but does not start them. If "preconnect" is set, the
+ * parent also connects to the Server on behalf of each client thread, so that
+ * the clients don't have to share the parent's vka while connecting.
+ */
+static void setup_clients(struct env *env, bool is_process, int n_clients,
+                          bool mint_2nd_ep_cap, bool preconnect)
 {
     int error;
 
-    error = serial_server_parent_spawn_thread(&env->simple,
-                                              &env->vka, &env->vspace,
-                                              SERSERV_TEST_PRIO_SERVER);
-
-    test_eq(error, 0);
-
-    init_file_globals(env);
+    init_file_globals(env, n_clients);
     create_clients(env, is_process);
     error = mint_server_ep_to_clients(env, mint_2nd_ep_cap);
     test_eq(error, 0);
@@ -624,15 +762,42 @@ static int concurrency_test_common(struct env *env, bool is_process, client_test
         error = alloc_untypeds_for_clients(env);
         test_eq(error, 0);
         copy_client_data_to_shmem(env);
-    };
+    } else if (preconnect) {
+        for (int i = 0; i < client_globals.n_clients; i++) {
+            client_test_data_t *curr_client = &client_globals.client_test_data[i];
+
+            error = serial_server_client_connect(curr_client->badged_server_ep_cspath.capPtr,
+                                                 &env->vka, &env->vspace,
+                                                 &curr_client->conn);
+            test_eq(error, 0);
+            curr_client->preconnected = true;
+        }
+    }
+}
 
-    start_clients(env, test_fn);
+static void wait_for_clients(struct env *env)
+{
+    int error;
 
-    for (int i = 0; i < SERSERV_TEST_N_CLIENTS; i++) {
+    for (int i = 0; i < client_globals.n_clients; i++) {
         error = wait_for_helper(&client_globals.client_test_data[i].thread);
         test_eq(error, 0);
     }
+}
+
+static int concurrency_test_common(struct env *env, bool is_process, client_test_fn *test_fn, bool mint_2nd_ep_cap)
+{
+    int error;
+
+    error = serial_server_parent_spawn_thread(&env->simple,
+                                              &env->vka, &env->vspace,
+                                              SERSERV_TEST_PRIO_SERVER);
+
+    test_eq(error, 0);
 
+    setup_clients(env, is_process, SERSERV_TEST_N_CLIENTS, mint_2nd_ep_cap, false);
+    start_clients(env, test_fn);
+    wait_for_clients(env);
     cleanup_clients(env);
     return 0;
 }
@@ -787,3 +952,88 @@ DEFINE_TEST(SERSERV_CLI_PROC_005, "Connect to server then disconnect on all "
             "clients (in different VSpace/CSpace containers), and finally kill "
             "the server from the parent",
             test_client_process_kill, true)
+
+/* Runs one round of SERSERV_PERF0001 and returns how long it took for all
+ * clients to finish. Client threads are connected by the parent beforehand;
+ * client processes have to connect themselves, so their rounds include the
+ * cost of one connect() per client.
+ */
+static uint64_t serserv_perf_round(struct env *env, bool is_process, client_test_fn *test_fn,
+                                   int n_clients)
+{
+    uint64_t start, end;
+
+    setup_clients(env, is_process, n_clients, false, true);
+
+    start = sel4test_timestamp(env);
+    start_clients(env, test_fn);
+    wait_for_clients(env);
+    end = sel4test_timestamp(env);
+
+    cleanup_clients(env);
+    return end - start;
+}
+
+static int
+test_client_throughput(struct env *env)
+{
+    int error;
+    serial_client_context_t conn;
+    cspacepath_t badged_server_ep_cspath;
+    size_t len = strlen(perf_str);
+    seL4_Word writes_per_ipc = SERIAL_BATCH_BUF_SIZE / len;
+    struct {
+        const char *variant;
+        bool is_process;
+        client_test_fn *test_fn;
+        seL4_Word ipcs;
+    } rounds[] = {
+        {"thread_write", false, &client_throughput_main, SERSERV_PERF_N_WRITES},
+        {"thread_batch_model", false, &client_batched_throughput_main,
+         (SERSERV_PERF_N_WRITES + writes_per_ipc - 1) / writes_per_ipc},
+        {"process_write", true, &client_throughput_main, SERSERV_PERF_N_WRITES},
+        {"process_batch_model", true, &client_batched_throughput_main,
+         (SERSERV_PERF_N_WRITES + writes_per_ipc - 1) / writes_per_ipc},
+    };
+
+    error = serial_server_parent_spawn_thread(&env->simple,
+                                              &env->vka, &env->vspace,
+                                              SERSERV_TEST_PRIO_SERVER);
+    test_eq(error, 0);
+
+    for (int r = 0; r < ARRAY_SIZE(rounds); r++) {
+        for (int n_clients = 1; n_clients <= SERSERV_TEST_MAX_CLIENTS; n_clients *= 2) {
+            uint64_t elapsed = serserv_perf_round(env, rounds[r].is_process, rounds[r].test_fn, n_clients);
+            uint64_t bytes = (uint64_t) n_clients * SERSERV_PERF_N_WRITES * len;
+
+            /* The clients run concurrently, so each client sees each of its
+             * IPC rounds with the Server take elapsed / ipcs on average. A round
+             * carries a whole batch, so the time per write is that divided by
+             * the writes per round, which is comparable across the variants. */
+            perf_print("SERSERV_PERF0001", rounds[r].variant, n_clients, "bytes_per_s",
+                       elapsed ? bytes * NS_IN_S / elapsed : 0);
+            perf_print("SERSERV_PERF0001", rounds[r].variant, n_clients, "round_ns",
+                       elapsed / rounds[r].ipcs);
+            perf_print("SERSERV_PERF0001", rounds[r].variant, n_clients, "write_ns",
+                       elapsed / SERSERV_PERF_N_WRITES);
+            perf_print("SERSERV_PERF0001", rounds[r].variant, n_clients, "ipcs",
+                       n_clients * rounds[r].ipcs);
+        }
+    }
+
+    error = serial_server_parent_vka_mint_endpoint(&env->vka, &badged_server_ep_cspath);
+    test_eq(error, 0);
+    error = serial_server_client_connect(badged_server_ep_cspath.capPtr,
+                                         &env->vka, &env->vspace, &conn);
+    test_eq(error, 0);
+    error = serial_server_kill(&conn);
+    test_eq(error, 0);
+    return sel4test_get_result();
+}
+DEFINE_TEST(SERSERV_PERF0001, "Measure serial server write throughput and latency "
+            "with multiple client threads and processes, with and without batching",
+            test_client_throughput, config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER))
+/* Mostly printing the writes, about 2 KiB for each client of each round, which
+ * is about 200 ms on a 115200 baud console. There are 4 variants, each run with
+ * 1, 2, 4 ... SERSERV_TEST_MAX_CLIENTS clients, see Sel4testSerservPerfClients. */
+DEFINE_TEST_BUDGET(SERSERV_PERF0001, 4 * (2 * SERSERV_TEST_MAX_CLIENTS - 1) * 200, TEST_BUDGET_FIXED)
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
 #include <stdio.h>
 #include <sync/sem.h>
 #include <sync/bin_sem.h>
@@ -12,6 +14,7 @@
 
 #include "../test.h"
 #include "../helpers.h"
+#include "../perf.h"
 
 static volatile int shared = 0;
 sync_bin_sem_t bin_sem = {{0}};
@@ -327,3 +330,243 @@ static int test_monitor_broadcast(struct env *env)
     return sel4test_get_result();
 }
 DEFINE_TEST(SYNC004, "libsel4sync Test monitors - broadcast", test_monitor_broadcast, true)
+
+/* Largest number of contending threads in SYNC_PERF0001 and SYNC_PERF0002 */
+#define SYNC_PERF_MAX_THREADS 64
+/* Contending threads are spread over this many priorities below ours */
+#define SYNC_PERF_PRIO_LEVELS 4
+/* Total acquire/release pairs per run of SYNC_PERF0001 */
+#define SYNC_PERF_OPS 4096
+/* Broadcasts per run of SYNC_PERF0002 */
+#define SYNC_PERF_BROADCASTS 100
+
+static helper_thread_t sync_perf_threads[SYNC_PERF_MAX_THREADS];
+static volatile seL4_Word sync_perf_ops[SYNC_PERF_MAX_THREADS];
+static volatile seL4_Word sync_perf_total;
+static volatile bool sync_perf_go;
+
+/* Create "n" helpers, each on its own priority level and core in turn */
+static void sync_perf_create_threads(env_t env, int n)
+{
+    for (int i = 0; i < n; i++) {
+        create_helper_thread(env, &sync_perf_threads[i]);
+        set_helper_priority(env, &sync_perf_threads[i], OUR_PRIO - 1 - (i % SYNC_PERF_PRIO_LEVELS));
+        if (env->cores > 1) {
+            set_helper_affinity(env, &sync_perf_threads[i], i % env->cores);
+        }
+        sync_perf_ops[i] = 0;
+    }
+    sync_perf_total = 0;
+    sync_perf_go = false;
+}
+
+static void sync_perf_join_threads(env_t env, int n)
+{
+    for (int i = 0; i < n; i++) {
+        wait_for_helper(&sync_perf_threads[i]);
+        cleanup_helper(env, &sync_perf_threads[i]);
+    }
+}
+
+/* Helpers on other cores start running as soon as they are started, so hold
+ * them until all of them exist */
+static void sync_perf_wait_for_go(void)
+{
+    while (!sync_perf_go) {
+        seL4_Yield();
+    }
+}
+
+/* Print per thread acquisitions and Jain's fairness index (in 1/1000ths,
+ * 1000 meaning every thread got an equal share) */
+static void sync_perf_print_fairness(const char *test, const char *variant, int n)
+{
+    seL4_Word min = sync_perf_ops[0], max = sync_perf_ops[0];
+    uint64_t sum = 0, sum_sq = 0;
+
+    for (int i = 0; i < n; i++) {
+        min = MIN(min, sync_perf_ops[i]);
+        max = MAX(max, sync_perf_ops[i]);
+        sum += sync_perf_ops[i];
+        sum_sq += (uint64_t) sync_perf_ops[i] * sync_perf_ops[i];
+    }
+
+    perf_print(test, variant, n, "min_ops", min);
+    perf_print(test, variant, n, "max_ops", max);
+    perf_print(test, variant, n, "fairness", sum_sq ? sum * sum * 1000 / (n * sum_sq) : 0);
+}
+
+static int sync_perf_bin_sem_func(seL4_Word id)
+{
+    sync_perf_wait_for_go();
+
+    while (true) {
+        sync_bin_sem_wait(&bin_sem);
+        if (sync_perf_total >= SYNC_PERF_OPS) {
+            sync_bin_sem_post(&bin_sem);
+            break;
+        }
+        sync_perf_total++;
+        sync_perf_ops[id]++;
+        sync_bin_sem_post(&bin_sem);
+    }
+
+    return 0;
+}
+
+/* Pass a token around a ring of threads, each blocked on its own semaphore,
+ * so that every acquire is a handoff to a thread that is already waiting */
+static sync_bin_sem_t sync_perf_ring[SYNC_PERF_MAX_THREADS];
+
+static int sync_perf_ring_func(seL4_Word id, seL4_Word n)
+{
+    for (int i = 0; i < SYNC_PERF_OPS / n; i++) {
+        sync_bin_sem_wait(&sync_perf_ring[id]);
+        sync_bin_sem_post(&sync_perf_ring[(id + 1) % n]);
+    }
+
+    return 0;
+}
+
+static int test_bin_sem_contention(env_t env)
+{
+    int error;
+    uint64_t start, end, overhead;
+
+    error = sync_bin_sem_new(&env->vka, &bin_sem, 1);
+    test_eq(error, 0);
+    overhead = perf_timestamp_overhead(env);
+
+    for (int n = 1; n <= SYNC_PERF_MAX_THREADS; n *= 2) {
+        /* Throughput and fairness with every thread contending for one semaphore */
+        sync_perf_create_threads(env, n);
+        for (int i = 0; i < n; i++) {
+            start_helper(env, &sync_perf_threads[i], (helper_fn_t) sync_perf_bin_sem_func, i, 0, 0, 0);
+        }
+        start = sel4test_timestamp(env);
+        sync_perf_go = true;
+        sync_perf_join_threads(env, n);
+        end = sel4test_timestamp(env);
+
+        test_eq(sync_perf_total, (seL4_Word) SYNC_PERF_OPS);
+        uint64_t elapsed = perf_sample(start, end, overhead);
+        perf_print("SYNC_PERF0001", "contended", n, "ops_per_s", elapsed ? SYNC_PERF_OPS * NS_IN_S / elapsed : 0);
+        perf_print("SYNC_PERF0001", "contended", n, "op_ns", elapsed / SYNC_PERF_OPS);
+        sync_perf_print_fairness("SYNC_PERF0001", "contended", n);
+
+        /* Handoff latency between waiting threads */
+        for (int i = 0; i < n; i++) {
+            error = sync_bin_sem_new(&env->vka, &sync_perf_ring[i], 0);
+            test_eq(error, 0);
+        }
+        sync_perf_create_threads(env, n);
+        for (int i = 0; i < n; i++) {
+            start_helper(env, &sync_perf_threads[i], (helper_fn_t) sync_perf_ring_func, i, n, 0, 0);
+        }
+        start = sel4test_timestamp(env);
+        sync_bin_sem_post(&sync_perf_ring[0]);
+        sync_perf_join_threads(env, n);
+        end = sel4test_timestamp(env);
+
+        elapsed = perf_sample(start, end, overhead);
+        perf_print("SYNC_PERF0001", "handoff", n, "ns", elapsed / (SYNC_PERF_OPS / n * n));
+        for (int i = 0; i < n; i++) {
+            sync_bin_sem_destroy(&env->vka, &sync_perf_ring[i]);
+        }
+    }
+
+    sync_bin_sem_destroy(&env->vka, &bin_sem);
+    return sel4test_get_result();
+}
+DEFINE_TEST(SYNC_PERF0001, "libsel4sync binary semaphore contention scaling",
+            test_bin_sem_contention, config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER))
+/* mostly creating 2 * (2 * SYNC_PERF_MAX_THREADS - 1) helper threads */
+DEFINE_TEST_BUDGET(SYNC_PERF0001, 1000, TEST_BUDGET_FIXED)
+
+static volatile seL4_Word sync_perf_generation;
+
+static int sync_perf_waiter_func(seL4_Word id, seL4_Word n)
+{
+    seL4_Word seen = 0;
+
+    while (seen < SYNC_PERF_BROADCASTS) {
+        sync_bin_sem_wait(&monitor_lock);
+        while (sync_perf_generation == seen) {
+            sync_cv_wait(&monitor_lock, &consumer_cv);
+        }
+        seen = sync_perf_generation;
+        /* accumulate the order we were woken in to report fairness */
+        sync_perf_ops[id] += sync_perf_total;
+        sync_perf_total++;
+        if (sync_perf_total == n) {
+            sync_cv_signal(&broadcaster_cv);
+        }
+        sync_bin_sem_post(&monitor_lock);
+    }
+
+    return 0;
+}
+
+static int test_monitor_broadcast_contention(env_t env)
+{
+    int error;
+    uint64_t start, end, overhead;
+
+    error = sync_bin_sem_new(&env->vka, &monitor_lock, 1);
+    test_eq(error, 0);
+    error = sync_cv_new(&env->vka, &consumer_cv);
+    test_eq(error, 0);
+    error = sync_cv_new(&env->vka, &broadcaster_cv);
+    test_eq(error, 0);
+    overhead = perf_timestamp_overhead(env);
+
+    for (int n = 1; n <= SYNC_PERF_MAX_THREADS; n *= 2) {
+        sync_perf_generation = 0;
+        sync_perf_create_threads(env, n);
+        for (int i = 0; i < n; i++) {
+            start_helper(env, &sync_perf_threads[i], (helper_fn_t) sync_perf_waiter_func, i, n, 0, 0);
+        }
+
+        /* We are the broadcaster. Each round wakes all waiters, then waits
+         * for every one of them to have seen the new generation */
+        start = sel4test_timestamp(env);
+        for (int r = 0; r < SYNC_PERF_BROADCASTS; r++) {
+            sync_bin_sem_wait(&monitor_lock);
+            sync_perf_total = 0;
+            sync_perf_generation++;
+            sync_cv_broadcast_release(&monitor_lock, &consumer_cv);
+
+            sync_bin_sem_wait(&monitor_lock);
+            while (sync_perf_total < n) {
+                sync_cv_wait(&monitor_lock, &broadcaster_cv);
+            }
+            sync_bin_sem_post(&monitor_lock);
+        }
+        end = sel4test_timestamp(env);
+        sync_perf_join_threads(env, n);
+
+        uint64_t elapsed = perf_sample(start, end, overhead);
+        perf_print("SYNC_PERF0002", "broadcast", n, "round_ns", elapsed / SYNC_PERF_BROADCASTS);
+        perf_print("SYNC_PERF0002", "broadcast", n, "wakeups_per_s",
+                   elapsed ? (uint64_t) SYNC_PERF_BROADCASTS * n * NS_IN_S / elapsed : 0);
+        seL4_Word first = UINT32_MAX, last = 0;
+        for (int i = 0; i < n; i++) {
+            first = MIN(first, sync_perf_ops[i] / SYNC_PERF_BROADCASTS);
+            last = MAX(last, sync_perf_ops[i] / SYNC_PERF_BROADCASTS);
+        }
+        /* mean position each waiter is woken in; equal for all waiters if
+         * wakeups are fair, 0 for a waiter that is always woken first */
+        perf_print("SYNC_PERF0002", "broadcast", n, "min_wake_pos", first);
+        perf_print("SYNC_PERF0002", "broadcast", n, "max_wake_pos", last);
+        test_assert(!consumer_cv.broadcasting);
+    }
+
+    sync_cv_destroy(&env->vka, &consumer_cv);
+    sync_cv_destroy(&env->vka, &broadcaster_cv);
+    sync_bin_sem_destroy(&env->vka, &monitor_lock);
+    return sel4test_get_result();
+}
+DEFINE_TEST(SYNC_PERF0002, "libsel4sync monitor broadcast scaling",
+            test_monitor_broadcast_contention, config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER))
+/* mostly creating 2 * SYNC_PERF_MAX_THREADS - 1 helper threads */
+DEFINE_TEST_BUDGET(SYNC_PERF0002, 1000, TEST_BUDGET_FIXED)
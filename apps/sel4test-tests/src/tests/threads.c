@@ -6,12 +6,19 @@
 
 /* This file contains tests related to TCB syscalls. */
 
+#include <autoconf.h>
+#include <sel4test-driver/gen_config.h>
+
 #include <stdio.h>
 #include <sel4/sel4.h>
+#include <sel4runtime.h>
 #include <sel4test/testutil.h>
 #include <sel4test/macros.h>
+#include <vka/object.h>
 
+#include "../alloc_batch.h"
 #include "../helpers.h"
+#include "../perf.h"
 
 int test_tcb_null_cspace_configure(env_t env)
 {
@@ -50,3 +57,171 @@ int test_tcb_null_cspace_setspace(env_t env)
 }
 DEFINE_TEST(THREADS0005, "seL4_TCB_SetSpace with a NULL CSpace should fail", test_tcb_null_cspace_setspace, true)
 
+
+/* create/start/join/destroy cycles timed for each kind of helper */
+#define THREADS_PERF_ITERATIONS 100
+
+static int threads_perf_nop(void)
+{
+    return 0;
+}
+
+static void threads_perf_print_phase(const char *variant, perf_stats_t *stats)
+{
+    perf_stats_print("THREADS_PERF0001", variant, THREADS_PERF_ITERATIONS, stats);
+}
+
+static void threads_perf_print_throughput(const char *variant, perf_stats_t *total)
+{
+    uint64_t mean = perf_stats_mean(total);
+    perf_print("THREADS_PERF0001", variant, THREADS_PERF_ITERATIONS, "cycles_per_s", mean ? NS_IN_S / mean : 0);
+}
+
+/* Time a full create_helper_thread, start_helper, wait_for_helper, cleanup_helper cycle */
+static void threads_perf_thread_cycles(env_t env, uint64_t overhead)
+{
+    perf_stats_t create, run, destroy, total;
+    perf_stats_init(&create);
+    perf_stats_init(&run);
+    perf_stats_init(&destroy);
+    perf_stats_init(&total);
+
+    for (int i = 0; i < THREADS_PERF_ITERATIONS; i++) {
+        helper_thread_t helper;
+        uint64_t t0 = sel4test_timestamp(env);
+        create_helper_thread(env, &helper);
+        uint64_t t1 = sel4test_timestamp(env);
+        start_helper(env, &helper, (helper_fn_t) threads_perf_nop, 0, 0, 0, 0);
+        wait_for_helper(&helper);
+        uint64_t t2 = sel4test_timestamp(env);
+        cleanup_helper(env, &helper);
+        uint64_t t3 = sel4test_timestamp(env);
+
+        perf_stats_add(&create, perf_sample(t0, t1, overhead));
+        perf_stats_add(&run, perf_sample(t1, t2, overhead));
+        perf_stats_add(&destroy, perf_sample(t2, t3, overhead));
+        perf_stats_add(&total, perf_sample(t0, t3, overhead));
+    }
+
+    threads_perf_print_phase("thread_create", &create);
+    threads_perf_print_phase("thread_start_join", &run);
+    threads_perf_print_phase("thread_destroy", &destroy);
+    threads_perf_print_phase("thread_total", &total);
+    threads_perf_print_throughput("thread", &total);
+}
+
+/* Time a full create_helper_process, start_helper, wait_for_helper, cleanup_helper
+ * cycle, with creation split into configuring the process and cloning our image */
+static void threads_perf_process_cycles(env_t env, uint64_t overhead)
+{
+    perf_stats_t configure, clone, run, destroy, total;
+    perf_stats_init(&configure);
+    perf_stats_init(&clone);
+    perf_stats_init(&run);
+    perf_stats_init(&destroy);
+    perf_stats_init(&total);
+
+    for (int i = 0; i < THREADS_PERF_ITERATIONS; i++) {
+        helper_thread_t helper;
+        uint64_t t0 = sel4test_timestamp(env);
+        configure_helper_process(env, &helper, env->asid_pool);
+        uint64_t t1 = sel4test_timestamp(env);
+        clone_into_helper_process(env, &helper);
+        uint64_t t2 = sel4test_timestamp(env);
+        start_helper(env, &helper, (helper_fn_t) threads_perf_nop, 0, 0, 0, 0);
+        wait_for_helper(&helper);
+        uint64_t t3 = sel4test_timestamp(env);
+        cleanup_helper(env, &helper);
+        uint64_t t4 = sel4test_timestamp(env);
+
+        perf_stats_add(&configure, perf_sample(t0, t1, overhead));
+        perf_stats_add(&clone, perf_sample(t1, t2, overhead));
+        perf_stats_add(&run, perf_sample(t2, t3, overhead));
+        perf_stats_add(&destroy, perf_sample(t3, t4, overhead));
+        perf_stats_add(&total, perf_sample(t0, t4, overhead));
+    }
+
+    threads_perf_print_phase("process_configure", &configure);
+    threads_perf_print_phase("process_clone", &clone);
+    threads_perf_print_phase("process_start_join", &run);
+    threads_perf_print_phase("process_destroy", &destroy);
+    threads_perf_print_phase("process_total", &total);
+    threads_perf_print_throughput("process", &total);
+}
+
+/* Time the steps sel4utils takes inside thread creation on their own: retyping
+ * the kernel objects, mapping a stack and writing the TLS image. The objects are
+ * retyped one at a time even with CONFIG_SEL4TEST_BATCH_ALLOC. */
+static void threads_perf_thread_phases(env_t env, uint64_t overhead)
+{
+    vka_t vka;
+    alloc_batch_unwrap_vka(&env->vka, &vka);
+    static char __attribute__((aligned(16))) tls_region[1024 * 16];
+    size_t stack_pages = BYTES_TO_4K_PAGES(CONFIG_SEL4UTILS_STACK_SIZE);
+    perf_stats_t retype, stack, tls;
+    perf_stats_init(&retype);
+    perf_stats_init(&stack);
+    perf_stats_init(&tls);
+
+    test_assert_fatal(sel4runtime_get_tls_size() <= sizeof(tls_region));
+
+    for (int i = 0; i < THREADS_PERF_ITERATIONS; i++) {
+        vka_object_t tcb, ipc_frame, endpoint;
+#ifdef CONFIG_KERNEL_MCS
+        vka_object_t sched_context, reply;
+#endif
+        int error = 0;
+
+        uint64_t t0 = sel4test_timestamp(env);
+        error |= vka_alloc_tcb(&vka, &tcb);
+        error |= vka_alloc_frame(&vka, seL4_PageBits, &ipc_frame);
+        error |= vka_alloc_endpoint(&vka, &endpoint);
+#ifdef CONFIG_KERNEL_MCS
+        error |= vka_alloc_sched_context(&vka, &sched_context);
+        error |= vka_alloc_reply(&vka, &reply);
+#endif
+        uint64_t t1 = sel4test_timestamp(env);
+        test_assert_fatal(error == 0);
+
+        void *stack_top = vspace_new_sized_stack(&env->vspace, stack_pages);
+        uint64_t t2 = sel4test_timestamp(env);
+        test_assert_fatal(stack_top != NULL);
+
+        uintptr_t tp = sel4runtime_write_tls_image(tls_region);
+        error = seL4_TCB_SetTLSBase(tcb.cptr, tp);
+        uint64_t t3 = sel4test_timestamp(env);
+        test_error_eq(error, seL4_NoError);
+
+        perf_stats_add(&retype, perf_sample(t0, t1, overhead));
+        perf_stats_add(&stack, perf_sample(t1, t2, overhead));
+        perf_stats_add(&tls, perf_sample(t2, t3, overhead));
+
+        vspace_free_sized_stack(&env->vspace, stack_top, stack_pages);
+#ifdef CONFIG_KERNEL_MCS
+        vka_free_object(&vka, &reply);
+        vka_free_object(&vka, &sched_context);
+#endif
+        vka_free_object(&vka, &endpoint);
+        vka_free_object(&vka, &ipc_frame);
+        vka_free_object(&vka, &tcb);
+    }
+
+    threads_perf_print_phase("phase_retype", &retype);
+    threads_perf_print_phase("phase_stack_map", &stack);
+    threads_perf_print_phase("phase_tls", &tls);
+}
+
+int test_helper_lifecycle_throughput(env_t env)
+{
+    uint64_t overhead = perf_timestamp_overhead(env);
+
+    threads_perf_thread_cycles(env, overhead);
+    threads_perf_process_cycles(env, overhead);
+    threads_perf_thread_phases(env, overhead);
+
+    return sel4test_get_result();
+}
+DEFINE_TEST(THREADS_PERF0001, "Measure helper thread and process create/start/join/destroy throughput",
+            test_helper_lifecycle_throughput, config_set(CONFIG_SEL4TEST_PERF) &&config_set(CONFIG_HAVE_TIMER))
+/* mostly the THREADS_PERF_ITERATIONS helper processes, at up to 20 ms each */
+DEFINE_TEST_BUDGET(THREADS_PERF0001, THREADS_PERF_ITERATIONS * 30, TEST_BUDGET_FIXED)
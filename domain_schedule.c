@@ -12,6 +12,9 @@
  * overall idle time. We pick 2 ticks as the shortest period so that tests can
  * make some progress if they exist, and we pick some variety in the first four
  * domains so that not everything is equal.
+ *
+ * Other schedules can be built without editing this file by setting
+ * Sel4testDomainSchedule, which generates the schedule from domain_schedule.c.in.
  */
 
 /* remember that this is compiled as part of the kernel, and so is referencing kernel headers */
@@ -20,3 +20,46 @@
  */
 testcase_t *sel4test_get_test(const char *name);
 
+
+/*
+ * Get a testcase by its position in the _test_case section, as found by
+ * sel4test-driver when it reads the section from the ELF file.
+ *
+ * @param index the index of the test in the section.
+ * @return the test at index, NULL if index is out of range.
+ */
+testcase_t *sel4test_get_test_by_index(int index);
+
+
+/*
+ * The expected duration of a test, for tests that are expected to take longer
+ * than the default for their test type. sel4test-driver flags tests that take
+ * more than CONFIG_SEL4TEST_BUDGET_FACTOR times their budget when
+ * CONFIG_SEL4TEST_DURATION_BUDGETS is set.
+ *
+ * A budget also applies to the tests defined by DEFINE_TEST_PARAM for the
+ * test of the same name. Budgets of tests whose time goes on sleeps that are
+ * divided by CONFIG_SEL4TEST_TIME_SCALE should be TEST_BUDGET_SCALED, so that
+ * they are divided by it too, but are never less than the default for the
+ * test's type. Other budgets, such as those of PERF tests, are
+ * TEST_BUDGET_FIXED.
+ */
+#define TEST_BUDGET_FIXED 0
+#define TEST_BUDGET_SCALED 1
+
+typedef struct test_budget {
+    char name[TEST_NAME_MAX];
+    seL4_Word budget_ms;
+    /* TEST_BUDGET_FIXED or TEST_BUDGET_SCALED */
+    seL4_Word scale;
+} test_budget_t;
+
+#define DEFINE_TEST_BUDGET(_name, _budget_ms, _scale) \
+    __attribute__((used)) __attribute__((section("_test_budget"))) test_budget_t TEST_BUDGET_ ## _name = { \
+        #_name, \
+        _budget_ms, \
+        _scale, \
+    };
+
+extern test_budget_t __start__test_budget[];
+extern test_budget_t __stop__test_budget[];
@@ -19,9 +19,10 @@
 
 #include <serial_server/test.h>
 
-/* Force the _test_type and _test_case section to be created even if no tests are defined. */
+/* Force the _test_type, _test_case and _test_budget sections to be created even if no tests are defined. */
 static USED SECTION("_test_type") struct {} dummy_test_type;
 static USED SECTION("_test_case") struct {} dummy_test_case;
+static USED SECTION("_test_budget") struct {} dummy_test_budget;
 
 /* Used to ensure that serial server parent tests are included */
 UNUSED void dummy_func()
@@ -41,3 +42,12 @@ testcase_t *sel4test_get_test(const char *name)
     return NULL;
 }
 
+testcase_t *sel4test_get_test_by_index(int index)
+{
+    if (index < 0 || index >= __stop__test_case - __start__test_case) {
+        return NULL;
+    }
+
+    return &__start__test_case[index];
+}
+
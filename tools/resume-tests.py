@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026, seL4 Project a Series of LF Projects, LLC
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+
+"""
+Resume sel4test runs that stopped early and merge their XML results.
+
+A run stops early when a test aborts, when TESTPRINTER_HALT_ON_TEST_FAILURE is
+set and a test fails, or when the target hangs. The next run can skip the tests
+that were already reported, either by building with
+-DSel4testStartIndex=<n> or, with Sel4testConsoleSelect, by typing start=<n> at
+boot.
+
+  resume-tests.py next LOG...            print the start index for the next run
+  resume-tests.py merge LOG... -o OUT    merge the XML results of the logs
+  resume-tests.py run --cmd CMD --log-dir DIR
+                                         run CMD until all tests have run
+
+For run, CMD is a shell command that boots the image and prints its console. Any
+{start} in it is replaced with the start index, for commands that rebuild the
+image. With --console the start index is typed in when the image asks for a
+test selection instead. The logs of each run and the merged results are written
+to DIR.
+
+The logs must come from images built with PRINT_XML and the same test
+selection.
+"""
+
+import argparse
+import os
+import re
+import select
+import subprocess
+import sys
+
+FIRST_TEST = "Test that there are tests"
+LAST_TEST = "Test all tests ran"
+
+START_RE = re.compile(r"Starting from test (\d+)")
+TESTCASE_RE = re.compile(r'\t<testcase classname="sel4test" name="(.*?)">\n(.*?)(\t</testcase>\n|\Z)', re.DOTALL)
+SELECTION_PROMPT = "Enter test selection"
+FINISHED = ("All is well in the universe", "*** FAILURES DETECTED ***", "*** ALL tests not run ***")
+HALTED = "Halting on"
+
+
+class Log:
+    """The test cases reported by one run."""
+
+    def __init__(self, text):
+        match = START_RE.search(text)
+        self.start = int(match.group(1)) if match else 0
+        self.finished = any(marker in text for marker in FINISHED)
+        self.halted = HALTED in text
+        self.cases = []
+        for match in TESTCASE_RE.finditer(text):
+            name, body, end = match.groups()
+            if not end:
+                # the run stopped during this test
+                if body and not body.endswith("\n"):
+                    body += "\n"
+                body += '\t\t<error type="failure" message="Run stopped before the test finished"/>\n'
+            self.cases.append((name, '\t<testcase classname="sel4test" name="%s">\n%s\t</testcase>\n'
+                               % (name, body)))
+
+    def tests(self):
+        """The test cases that are numbered, leaving out the ones every run reports."""
+        return [case for case in self.cases if case[0] not in (FIRST_TEST, LAST_TEST)]
+
+    def complete(self):
+        return self.finished and not self.halted
+
+    def next_start(self):
+        """The number of the first test this run did not report."""
+        return max(self.start, 1) + len(self.tests())
+
+
+def read_logs(paths):
+    logs = []
+    for path in paths:
+        with open(path, errors="replace") as f:
+            logs.append(Log(f.read()))
+    return logs
+
+
+def merge(logs):
+    cases = []
+    first = [case for case in logs[0].cases if case[0] == FIRST_TEST]
+    last = [case for case in logs[-1].cases if case[0] == LAST_TEST]
+    for log in logs:
+        cases += log.tests()
+    return "<testsuite>\n" + "".join(case for _, case in first + cases + last) + "</testsuite>\n"
+
+
+def run_once(cmd, start, console, timeout, log_path):
+    """Run the image once, logging its output, until it finishes or goes quiet."""
+    proc = subprocess.Popen(cmd.replace("{start}", str(start)), shell=True, stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(log_path, "w") as log:
+        while True:
+            ready, _, _ = select.select([proc.stdout], [], [], timeout)
+            if not ready:
+                print("No output for %d seconds, stopping the run" % timeout, file=sys.stderr)
+                break
+            line = proc.stdout.readline()
+            if not line:
+                break
+            log.write(line)
+            sys.stdout.write(line)
+            if console and SELECTION_PROMPT in line:
+                proc.stdin.write("start=%d\n" % start)
+                proc.stdin.flush()
+            if any(marker in line for marker in FINISHED):
+                break
+    if proc.poll() is None:
+        proc.kill()
+    proc.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    next_parser = commands.add_parser("next", help="print the start index for the next run")
+    next_parser.add_argument("logs", nargs="+")
+    merge_parser = commands.add_parser("merge", help="merge the XML results of several runs")
+    merge_parser.add_argument("logs", nargs="+")
+    merge_parser.add_argument("-o", "--output", required=True)
+    run_parser = commands.add_parser("run", help="run until all tests have run")
+    run_parser.add_argument("--cmd", required=True)
+    run_parser.add_argument("--log-dir", required=True)
+    run_parser.add_argument("--start", type=int, default=0)
+    run_parser.add_argument("--console", action="store_true",
+                            help="type the start index in at boot, needs Sel4testConsoleSelect")
+    run_parser.add_argument("--timeout", type=int, default=600,
+                            help="seconds without output before a run is considered hung")
+    run_parser.add_argument("--max-runs", type=int, default=10)
+    args = parser.parse_args()
+
+    if args.command == "next":
+        print(read_logs(args.logs)[-1].next_start())
+    elif args.command == "merge":
+        with open(args.output, "w") as f:
+            f.write(merge(read_logs(args.logs)))
+    elif args.command == "run":
+        os.makedirs(args.log_dir, exist_ok=True)
+        paths = []
+        start = args.start
+        for i in range(args.max_runs):
+            paths.append(os.path.join(args.log_dir, "run%d.log" % i))
+            run_once(args.cmd, start, args.console, args.timeout, paths[-1])
+            log = read_logs(paths[-1:])[0]
+            if log.complete():
+                break
+            if log.next_start() <= max(start, 1):
+                print("Run %d made no progress, giving up" % i, file=sys.stderr)
+                break
+            start = log.next_start()
+            print("Resuming from test %d" % start, file=sys.stderr)
+        with open(os.path.join(args.log_dir, "merged.xml"), "w") as f:
+            f.write(merge(read_logs(paths)))
+    else:
+        parser.print_help()
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
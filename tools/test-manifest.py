@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026, seL4 Project a Series of LF Projects, LLC
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+
+"""
+Build the sorted test manifest of sel4test-tests, and check test names.
+
+  test-manifest.py manifest --output FILE TESTS_ELF
+  test-manifest.py check ELF...
+
+Both read the test cases in the _test_case section of each ELF, each of which
+starts with the test's name and is found by its symbol in the section, and fail
+if a name is defined more than once across all of them.
+
+manifest writes the offset of each test in the _test_case section of TESTS_ELF,
+sorted by the test's name, as a 32 bit word in the byte order of TESTS_ELF.
+It is built before sel4test-driver is linked, which finds the tests in order
+from it instead of sorting them at boot.
+
+check is run on sel4test-driver and sel4test-tests once both are linked, as
+the bootstrap tests defined in the driver can only be checked then.
+"""
+
+import argparse
+import re
+import struct
+import subprocess
+import sys
+
+SECTION = "_test_case"
+# objdump -h: <index> <name> <size> <vma> <lma> <file offset> <align>
+HEADER_RE = re.compile(r"^\s*\d+\s+" + SECTION + r"\s+([0-9a-fA-F]+)\s+([0-9a-fA-F]+)\s")
+# objdump -t: <address> <flags> <section> <size> <name>
+SYMBOL_RE = re.compile(r"^([0-9a-fA-F]+)\s.*\s" + SECTION + r"\s+([0-9a-fA-F]+)\s+(\S+)$")
+# objdump -s: <address> <up to four groups of hex bytes> <ascii>
+CONTENTS_RE = re.compile(r"^ ([0-9a-fA-F]+) ((?:[0-9a-fA-F]{2,8} ?){1,4})")
+
+
+def objdump(tool, args, elf):
+    return subprocess.run([tool] + args + [elf], check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout.splitlines()
+
+
+def section_address(tool, elf):
+    for line in objdump(tool, ["-h", "-j", SECTION], elf):
+        match = HEADER_RE.match(line)
+        if match:
+            return int(match.group(2), 16)
+    sys.exit("%s has no %s section" % (elf, SECTION))
+
+
+def section_contents(tool, elf):
+    """The bytes of the section, by address."""
+    contents = {}
+    for line in objdump(tool, ["-s", "-j", SECTION], elf):
+        match = CONTENTS_RE.match(line)
+        if not match:
+            continue
+        address = int(match.group(1), 16)
+        data = bytes.fromhex(match.group(2).replace(" ", ""))
+        for i, byte in enumerate(data):
+            contents[address + i] = byte
+    return contents
+
+
+def test_cases(tool, elf):
+    """The name and address of each test, in the order of the section."""
+    contents = section_contents(tool, elf)
+    tests = []
+    for line in objdump(tool, ["-t"], elf):
+        match = SYMBOL_RE.match(line)
+        if not match or int(match.group(2), 16) == 0:
+            # the empty placeholder that makes sure the section exists
+            continue
+        address = int(match.group(1), 16)
+        name = bytearray()
+        while contents.get(address + len(name), 0) != 0:
+            name.append(contents[address + len(name)])
+        tests.append((bytes(name), address))
+    return sorted(tests, key=lambda test: test[1])
+
+
+def check_duplicates(tests_by_elf):
+    defined = {}
+    for elf, tests in tests_by_elf:
+        for name, _ in tests:
+            defined.setdefault(name, []).append(elf)
+
+    duplicates = {name: elfs for name, elfs in defined.items() if len(elfs) > 1}
+    for name, elfs in sorted(duplicates.items()):
+        print("Test %s is defined %d times, in %s" % (name.decode(errors="replace"), len(elfs), ", ".join(elfs)),
+              file=sys.stderr)
+    return not duplicates
+
+
+def byte_order(elf):
+    with open(elf, "rb") as f:
+        ident = f.read(6)
+    if ident[:4] != b"\x7fELF" or ident[5] not in (1, 2):
+        sys.exit("%s is not an ELF file" % elf)
+    return "<" if ident[5] == 1 else ">"
+
+
+def manifest(args):
+    tests = test_cases(args.objdump, args.elf)
+    if not check_duplicates([(args.elf, tests)]):
+        return 1
+
+    start = section_address(args.objdump, args.elf)
+    order = byte_order(args.elf)
+    with open(args.output, "wb") as f:
+        for _, address in sorted(tests):
+            f.write(struct.pack(order + "I", address - start))
+    return 0
+
+
+def check(args):
+    return 0 if check_duplicates([(elf, test_cases(args.objdump, elf)) for elf in args.elfs]) else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--objdump", default="objdump")
+    subparsers = parser.add_subparsers(dest="command")
+    subparsers.required = True
+
+    manifest_parser = subparsers.add_parser("manifest", help="write the sorted manifest of the tests ELF")
+    manifest_parser.add_argument("--output", required=True)
+    manifest_parser.add_argument("elf")
+    manifest_parser.set_defaults(func=manifest)
+
+    check_parser = subparsers.add_parser("check", help="check that no test name is defined twice")
+    check_parser.add_argument("elfs", nargs="+")
+    check_parser.set_defaults(func=check)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())